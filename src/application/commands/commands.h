@@ -1,11 +1,13 @@
 #pragma once
 
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "domain/factories/entity_factory.h"
 #include "domain/repositories/repository_interfaces.h"
 #include "domain/services/domain_services.h"
+#include "domain/services/transfer_service.h"
 #include "infrastructure/di/di_container.h"
 
 namespace financial::application {
@@ -108,17 +110,20 @@ class CreateCategoryCommand : public BaseCommand {
   CategoryType type_;
   std::string categoryName_;
   std::string description_;
+  Id parentId_;
   std::shared_ptr<Category> createdCategory_;
   std::shared_ptr<ICategoryRepository> repository_;
   std::shared_ptr<IEntityFactory> factory_;
 
  public:
   CreateCategoryCommand(CategoryType type, const std::string& categoryName,
-                        const std::string& description = "")
+                        const std::string& description = "",
+                        const Id& parentId = "")
       : BaseCommand("-Создать Категорию-"),
         type_(type),
         categoryName_(categoryName),
-        description_(description) {
+        description_(description),
+        parentId_(parentId) {
     repository_ = ServiceLocator::get<ICategoryRepository>();
     factory_ = ServiceLocator::get<IEntityFactory>();
   }
@@ -128,7 +133,7 @@ class CreateCategoryCommand : public BaseCommand {
  protected:
   void doExecute() override {
     createdCategory_ =
-        factory_->createCategory(type_, categoryName_, description_);
+        factory_->createCategory(type_, categoryName_, description_, parentId_);
     repository_->save(createdCategory_);
   }
 
@@ -154,10 +159,9 @@ class AddOperationCommand : public BaseCommand {
   Id categoryId_;
   std::string description_;
   std::shared_ptr<Operation> createdOperation_;
+  PostingSnapshots snapshots_;
   std::shared_ptr<OperationProcessingService> processingService_;
   std::shared_ptr<IEntityFactory> factory_;
-  std::shared_ptr<BankAccount> account_;
-  Money previousBalance_;
 
  public:
   AddOperationCommand(OperationType type, const Id& bankAccountId,
@@ -178,30 +182,48 @@ class AddOperationCommand : public BaseCommand {
  protected:
   void doExecute() override {
     auto accountRepo = ServiceLocator::get<IBankAccountRepository>();
-    auto accountOpt = accountRepo->findById(bankAccountId_);
-    if (!accountOpt) {
+    if (!accountRepo->findById(bankAccountId_)) {
       throw EntityNotFoundException("BankAccount", bankAccountId_);
     }
-    account_ = *accountOpt;
-    previousBalance_ = account_->getBalance();
 
     createdOperation_ = factory_->createOperation(
         type_, bankAccountId_, amount_, categoryId_, description_);
-    processingService_->processOperation(createdOperation_);
+    processingService_->processOperation(createdOperation_, &snapshots_);
   }
 
+  // Отмена восстанавливает версии операции и счёта из снимков до
+  // проводки. Остальные сущности не трогаются: записи, сделанные после
+  // команды, сохраняются. Если операцию или счёт после проводки уже
+  // меняли, восстановить их нельзя: операция удаляется, а со счёта
+  // снимается только её сумма
   void doUndo() override {
-    if (createdOperation_ && account_) {
-      // Удалить операцию
+    if (createdOperation_) {
+      const Id& operationId = createdOperation_->getId();
+      auto lock = ServiceLocator::get<AccountLockService>()->lock(bankAccountId_);
+
       auto operationRepo = ServiceLocator::get<IOperationRepository>();
-      operationRepo->remove(createdOperation_->getId());
+      if (!operationRepo->restore(snapshots_.operationsBefore,
+                                  snapshots_.operationsAfter,
+                                  {operationId})) {
+        operationRepo->remove(operationId);
+      }
+      ServiceLocator::get<BudgetService>()->revertExpense(*createdOperation_);
 
-      // Восстановить баланс счёта
-      account_->recalculateBalance(previousBalance_);
       auto accountRepo = ServiceLocator::get<IBankAccountRepository>();
-      accountRepo->update(account_);
+      if (!accountRepo->restore(snapshots_.accountsBefore,
+                                snapshots_.accountsAfter, {bankAccountId_})) {
+        if (auto account = accountRepo->findById(bankAccountId_)) {
+          const Money& amount = createdOperation_->getAmount();
+          Money balance = (*account)->getBalance();
+          (*account)->recalculateBalance(createdOperation_->isIncome()
+                                             ? balance.subtract(amount)
+                                             : balance.add(amount));
+          accountRepo->update(*account);
+        }
+      }
 
       createdOperation_ = nullptr;
+      snapshots_ = {};
     }
   }
 
@@ -218,8 +240,7 @@ class TransferCommand : public BaseCommand {
   Id toAccountId_;
   Money amount_;
   std::string description_;
-  std::shared_ptr<Operation> withdrawOperation_;
-  std::shared_ptr<Operation> depositOperation_;
+  std::optional<TransferReceipt> receipt_;
 
  public:
   TransferCommand(const Id& fromAccountId, const Id& toAccountId,
@@ -235,69 +256,17 @@ class TransferCommand : public BaseCommand {
 
  protected:
   void doExecute() override {
-    auto accountRepo = ServiceLocator::get<IBankAccountRepository>();
-    auto factory = ServiceLocator::get<IEntityFactory>();
-    auto operationRepo = ServiceLocator::get<IOperationRepository>();
-
-    auto fromAccountOpt = accountRepo->findById(fromAccountId_);
-    auto toAccountOpt = accountRepo->findById(toAccountId_);
-
-    if (!fromAccountOpt || !toAccountOpt) {
-      throw EntityNotFoundException(
-          "BankAccount", !fromAccountOpt ? fromAccountId_ : toAccountId_);
-    }
-
-    auto fromAccount = *fromAccountOpt;
-    auto toAccount = *toAccountOpt;
-
-    fromAccount->transfer(*toAccount, amount_);
-
-    accountRepo->update(fromAccount);
-    accountRepo->update(toAccount);
-
-    auto categoryRepo = ServiceLocator::get<ICategoryRepository>();
-    auto transferCategory = categoryRepo->findByName("Перевод");
-    if (!transferCategory) {
-      transferCategory = factory->createCategory(CategoryType::EXPENSE, "Перевод", "Переводы между счетами");
-      categoryRepo->save(*transferCategory);
-    }
-
-    // Операция списания
-    withdrawOperation_ = factory->createOperation(
-        OperationType::EXPENSE,
-        fromAccountId_,
-        amount_,
-        (*transferCategory)->getId(),
-        description_
-    );
-    operationRepo->save(withdrawOperation_);
-
-    // Операция зачисления
-    depositOperation_ = factory->createOperation(
-        OperationType::INCOME,
-        toAccountId_,
-        amount_,
-        (*transferCategory)->getId(),
-        description_
-    );
-    operationRepo->save(depositOperation_);
+    auto transferService = ServiceLocator::get<TransferService>();
+    receipt_ = transferService->transfer(fromAccountId_, toAccountId_, amount_,
+                                         description_);
   }
 
   void doUndo() override {
-    auto accountRepo = ServiceLocator::get<IBankAccountRepository>();
+    if (!receipt_) return;
 
-    auto fromAccountOpt = accountRepo->findById(fromAccountId_);
-    auto toAccountOpt = accountRepo->findById(toAccountId_);
-
-    if (fromAccountOpt && toAccountOpt) {
-      auto fromAccount = *fromAccountOpt;
-      auto toAccount = *toAccountOpt;
-
-      toAccount->transfer(*fromAccount, amount_);
-
-      accountRepo->update(fromAccount);
-      accountRepo->update(toAccount);
-    }
+    auto transferService = ServiceLocator::get<TransferService>();
+    transferService->revert(*receipt_);
+    receipt_.reset();
   }
 };
 
@@ -180,6 +180,21 @@ class AccountFacade {
     accountRepo_->remove(accountId);
   }
 
+  // Месячный бюджет счёта
+  void setBudget(const Id& accountId, double limit,
+                 BudgetPolicy policy = BudgetPolicy::WARN,
+                 const std::string& currency = "RUB") {
+    if (!getAccount(accountId)) {
+      throw EntityNotFoundException("BankAccount", accountId);
+    }
+    ServiceLocator::get<BudgetService>()->setAccountBudget(
+        accountId, Money(limit, currency), policy);
+  }
+
+  std::optional<BudgetStatus> getBudgetStatus(const Id& accountId) {
+    return ServiceLocator::get<BudgetService>()->getAccountStatus(accountId);
+  }
+
   // Операции с балансом
   Money getBalance(const Id& accountId) {
     auto account = getAccount(accountId);
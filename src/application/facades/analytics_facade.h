@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <unordered_map>
+#include <unordered_set>
 #include "domain/services/domain_services.h"
+#include "domain/services/forecast_service.h"
+#include "domain/services/statement_matcher.h"
 #include "infrastructure/serialization/data_exporter.h"
 #include "infrastructure/serialization/data_importer.h"
 
@@ -148,6 +153,19 @@ private:
     }
 };
 
+// Итог импорта: сколько создано, сколько обновлено по id
+// и сколько строк отброшено как дубликаты
+struct ImportSummary {
+    size_t accountsImported = 0;
+    size_t accountsUpdated = 0;
+    size_t categoriesImported = 0;
+    size_t categoriesUpdated = 0;
+    size_t operationsImported = 0;
+    size_t operationsUpdated = 0;
+    size_t exactDuplicates = 0;
+    size_t fuzzyDuplicates = 0;
+};
+
 // Фасад аналитики
 class AnalyticsFacade {
 private:
@@ -156,6 +174,10 @@ private:
     std::shared_ptr<IOperationRepository> operationRepo_;
     std::shared_ptr<IBankAccountRepository> accountRepo_;
     std::shared_ptr<ICategoryRepository> categoryRepo_;
+    std::shared_ptr<ThreadPool> threadPool_;
+    std::shared_ptr<BudgetService> budgetService_;
+    std::shared_ptr<AccountLockService> accountLocks_;
+    int compressionLevel_ = Gzip::DEFAULT_LEVEL;
 
 public:
     AnalyticsFacade() {
@@ -164,6 +186,18 @@ public:
         operationRepo_ = ServiceLocator::get<IOperationRepository>();
         accountRepo_ = ServiceLocator::get<IBankAccountRepository>();
         categoryRepo_ = ServiceLocator::get<ICategoryRepository>();
+        accountLocks_ = ServiceLocator::get<AccountLockService>();
+        if (ServiceLocator::has<ThreadPool>()) {
+            threadPool_ = ServiceLocator::get<ThreadPool>();
+        }
+        if (ServiceLocator::has<BudgetService>()) {
+            budgetService_ = ServiceLocator::get<BudgetService>();
+        }
+    }
+
+    // Счётчики общего пула потоков (пустые, если пул не зарегистрирован)
+    ThreadPoolMetrics getThreadPoolMetrics() const {
+        return threadPool_ ? threadPool_->metrics() : ThreadPoolMetrics{};
     }
 
     // Аналитика по периоду
@@ -198,6 +232,39 @@ public:
             DateRange::thisMonth(), OperationType::EXPENSE, limit);
     }
 
+    // Итоги по дереву категорий с учётом подкатегорий
+    std::vector<CategoryRollup> getCategoryRollups(
+        const DateRange& period,
+        OperationType type = OperationType::EXPENSE) {
+        return analyticsService_->calculateCategoryRollups(period, type);
+    }
+
+    // Сумма расходов (доходов) по операциям, подходящим под запрос по тегам
+    Money getTaggedTotal(const TagQuery& query, const DateRange& period,
+                         OperationType type = OperationType::EXPENSE) {
+        return analyticsService_->calculateTaggedTotal(query, period, type).total;
+    }
+
+    // Распределение сумм операций (медиана, p90, p99, гистограмма, выбросы)
+    PeriodDistribution getAmountDistribution(const DateRange& period,
+                                             size_t histogramBins = 10) {
+        return analyticsService_->calculateAmountDistribution(period, histogramBins);
+    }
+
+    PeriodDistribution getMonthDistribution() {
+        return getAmountDistribution(DateRange::thisMonth());
+    }
+
+    // Сигналы детектора аномалий, накопленные с прошлого вызова
+    std::vector<AnomalyAlert> takeAnomalyAlerts() {
+        return ServiceLocator::get<AnomalyDetector>()->getQueue()->drain();
+    }
+
+    // Прогноз балансов по активным счетам на months месяцев вперёд
+    std::vector<AccountForecast> forecastCashFlow(size_t months = 3) {
+        return ServiceLocator::get<CashFlowForecastService>()->forecast(months);
+    }
+
     // Согласование балансов
     AccountBalance checkBalance(const Id& accountId) {
         return reconciliationService_->checkAccountBalance(accountId);
@@ -257,33 +324,50 @@ public:
             .build();
     }
 
+    // Уровень сжатия для экспорта в файлы .gz: ниже — быстрее, выше — меньше
+    void setCompressionLevel(int level) {
+        if (!Gzip::isValidLevel(level)) {
+            throw ValidationException("Compression level must be between " +
+                                      std::to_string(Gzip::MIN_LEVEL) + " and " +
+                                      std::to_string(Gzip::MAX_LEVEL));
+        }
+        compressionLevel_ = level;
+    }
+
     // Экспорт данных
     void exportToCSV(const std::string& filename) {
-        auto exporter = ExporterFactory::create("csv");
-        exporter->exportToFile(
-            filename,
-            accountRepo_->findAll(),
-            categoryRepo_->findAll(),
-            operationRepo_->findAll()
-        );
+        exportFiltered("csv", filename, OperationFilter{});
     }
 
     void exportToJSON(const std::string& filename) {
-        auto exporter = ExporterFactory::create("json");
-        exporter->exportToFile(
-            filename,
-            accountRepo_->findAll(),
-            categoryRepo_->findAll(),
-            operationRepo_->findAll()
-        );
+        exportFiltered("json", filename, OperationFilter{});
+    }
+
+    // Экспорт подмножества: операции идут из снимка репозитория прямо
+    // в посетителя
+    void exportToCSV(const std::string& filename, const OperationFilter& filter) {
+        exportFiltered("csv", filename, filter);
     }
 
-    void importFromJSON(const std::string& filename) {
-        auto importer = ImporterFactory::create("json");
-        auto data = importer->import(filename);
+    void exportToJSON(const std::string& filename, const OperationFilter& filter) {
+        exportFiltered("json", filename, filter);
+    }
+
+    // Колоночный файл операций для внешнего анализа
+    void exportToColumnar(const std::string& filename,
+                          const OperationFilter& filter = OperationFilter{}) {
+        exportFiltered("fcol", filename, filter);
+    }
+
+    ImportSummary importFromJSON(const std::string& filename) {
+        JSONImporter importer;
+        importer.setThreadPool(threadPool_);
+        // Чтение идёт конвейером, а поля остаются представлениями
+        // во входном буфере до создания сущностей
+        ImportView data = importer.importViews(filename);
 
         // Обработка импортированных данных
-        processImportedData(data);
+        return processImportedData(data);
     }
 
     // Статистика
@@ -315,42 +399,310 @@ public:
     }
 
 private:
-    void processImportedData(const ImportData& data) {
+    // Выгрузка идёт из снимков репозиториев, снятых в начале: файл
+    // согласован, даже если во время записи идут проводки, и запись
+    // не держит блокировок репозиториев.
+    // Счета выгружаются только указанные в фильтре. Категории — все,
+    // если фильтр по ним не задан: их немного, а файл остаётся
+    // пригодным для импорта со ссылочной проверкой
+    void exportFiltered(const std::string& format, const std::string& filename,
+                        const OperationFilter& filter) {
+        auto accountSnapshot = accountRepo_->snapshot();
+        auto categorySnapshot = categoryRepo_->snapshot();
+        auto operationSnapshot = operationRepo_->snapshot();
+
+        auto accounts = selectFromSnapshot(*accountSnapshot, filter.accountIds);
+        auto categories =
+            selectFromSnapshot(*categorySnapshot, filter.categoryIds);
+
+        auto exporter = ExporterFactory::create(format);
+        exporter->setThreadPool(threadPool_);
+        exporter->setCompressionLevel(compressionLevel_);
+        exporter->exportToFile(
+            filename, accounts, categories,
+            [&](const DataExporter::OperationSink& sink) {
+                operationSnapshot->forEach([&](const Operation& operation) {
+                    if (matchesFilter(filter, operation)) sink(operation);
+                });
+            });
+    }
+
+    // Пустой список ids — все сущности снимка
+    template <typename T>
+    static std::vector<std::shared_ptr<T>> selectFromSnapshot(
+        const IRepositorySnapshot<T>& snapshot, const std::vector<Id>& ids) {
+        std::vector<std::shared_ptr<T>> result;
+        if (ids.empty()) {
+            snapshot.forEach([&result](const T& entity) {
+                result.push_back(std::make_shared<T>(entity));
+            });
+            return result;
+        }
+        for (const auto& id : ids) {
+            if (auto entity = snapshot.findById(id)) {
+                result.push_back(std::make_shared<T>(*entity));
+            }
+        }
+        return result;
+    }
+
+    static bool matchesFilter(const OperationFilter& filter,
+                              const Operation& operation) {
+        auto listed = [](const std::vector<Id>& ids, const Id& id) {
+            return ids.empty() ||
+                   std::find(ids.begin(), ids.end(), id) != ids.end();
+        };
+        bool inPeriod =
+            !filter.period || filter.period->contains(operation.getDate());
+        return inPeriod &&
+               listed(filter.accountIds, operation.getBankAccountId()) &&
+               listed(filter.categoryIds, operation.getCategoryId());
+    }
+
+    // Импорт как upsert: идентификаторы из файла сохраняются, поэтому
+    // ссылки операций на счета и категории остаются верными, а повторный
+    // импорт обновляет существующие сущности вместо создания копий.
+    // Для каждой сущности за один проход строится отображение
+    // id из файла -> id в хранилище, по нему разрешаются все ссылки.
+    // Ключи указывают в импортируемые данные и живут, пока идёт загрузка.
+    //
+    // Записи — DTO (ImportData) или представления (ImportView): строки
+    // представлений копируются только в создаваемые сущности.
+    using IdMap = std::unordered_map<std::string_view, Id>;
+
+    static const std::string& text(const std::string& value) { return value; }
+    static std::string text(std::string_view value) { return std::string(value); }
+
+    static DateTime operationDate(const OperationDTO& operation) {
+        return DateTimeUtils::fromString(operation.date);
+    }
+
+    static DateTime operationDate(const OperationView& operation) {
+        return operation.parsedDate
+                   ? *operation.parsedDate
+                   : DateTimeUtils::fromString(text(operation.date));
+    }
+
+    template <typename Data>
+    ImportSummary processImportedData(const Data& data) {
         auto factory = ServiceLocator::get<IEntityFactory>();
+        ImportSummary summary;
+
+        IdMap accountIds = importAccounts(*factory, data.accounts, summary);
+        IdMap categoryIds = importCategories(*factory, data.categories, summary);
+        importOperations(*factory, data.operations, accountIds, categoryIds,
+                         summary);
+        return summary;
+    }
+
+    // Целевой id: id из файла, если он корректен; иначе — id найденной
+    // по естественному ключу сущности; иначе новый
+    static Id resolveImportedId(std::string_view sourceId, const Id& naturalMatch,
+                                const std::string& prefix) {
+        if (Validator::checkId(sourceId) == ErrorCode::NONE) return Id(sourceId);
+        if (!naturalMatch.empty()) return naturalMatch;
+        return IdGenerator::generate(prefix);
+    }
+
+    static Id remapReference(const IdMap& ids, std::string_view sourceId) {
+        auto it = ids.find(sourceId);
+        return it == ids.end() ? Id(sourceId) : it->second;
+    }
+
+    template <typename AccountRecord>
+    IdMap importAccounts(IEntityFactory& factory,
+                         const std::vector<AccountRecord>& accounts,
+                         ImportSummary& summary) {
+        IdMap ids;
+        ids.reserve(accounts.size());
+        std::vector<std::shared_ptr<BankAccount>> inserted;
+
+        for (const auto& accountDTO : accounts) {
+            Id naturalMatch;
+            if (Validator::checkId(accountDTO.id) != ErrorCode::NONE &&
+                !accountDTO.accountNumber.empty()) {
+                if (auto found = accountRepo_->findByAccountNumber(
+                        text(accountDTO.accountNumber))) {
+                    naturalMatch = (*found)->getId();
+                }
+            }
+            Id id = resolveImportedId(accountDTO.id, naturalMatch, "ACC");
+            ids[accountDTO.id] = id;
+
+            auto account = factory.restoreBankAccount(
+                id, text(accountDTO.name),
+                Money(accountDTO.balance, text(accountDTO.currency)),
+                text(accountDTO.accountNumber));
+            // Баланс из файла заменяет текущий под блокировкой счёта
+            auto lock = accountLocks_->lock(id);
+            if (accountRepo_->findById(id)) {
+                accountRepo_->update(account);
+                summary.accountsUpdated++;
+            } else {
+                inserted.push_back(std::move(account));
+            }
+        }
 
-        // Импорт счетов
-        for (const auto& accountDTO : data.accounts) {
-            auto account = factory->createBankAccount(
-                accountDTO.name,
-                Money(accountDTO.balance, accountDTO.currency),
-                accountDTO.accountNumber
-            );
-            accountRepo_->save(account);
+        accountRepo_->saveAll(inserted);
+        summary.accountsImported = inserted.size();
+        return ids;
+    }
+
+    template <typename CategoryRecord>
+    IdMap importCategories(IEntityFactory& factory,
+                           const std::vector<CategoryRecord>& categories,
+                           ImportSummary& summary) {
+        IdMap ids;
+        ids.reserve(categories.size());
+        std::vector<Id> resolved;
+        resolved.reserve(categories.size());
+        for (const auto& categoryDTO : categories) {
+            Id naturalMatch;
+            if (Validator::checkId(categoryDTO.id) != ErrorCode::NONE) {
+                if (auto found = categoryRepo_->findByName(text(categoryDTO.name))) {
+                    naturalMatch = (*found)->getId();
+                }
+            }
+            resolved.push_back(
+                resolveImportedId(categoryDTO.id, naturalMatch, "CAT"));
+            ids[categoryDTO.id] = resolved.back();
         }
 
-        // Импорт категорий
-        for (const auto& categoryDTO : data.categories) {
-            auto type = stringToCategoryType(categoryDTO.type);
-            auto category = factory->createCategory(
-                type,
-                categoryDTO.name,
-                categoryDTO.description
-            );
-            categoryRepo_->save(category);
+        // Родитель разрешается после построения всего отображения:
+        // в файле дочерняя категория может стоять раньше родительской
+        std::vector<std::shared_ptr<Category>> inserted;
+        for (size_t i = 0; i < categories.size(); ++i) {
+            const auto& categoryDTO = categories[i];
+            const Id& id = resolved[i];
+            Id parentId;
+            if (!categoryDTO.parentId.empty()) {
+                parentId = remapReference(ids, categoryDTO.parentId);
+                if (parentId == id ||
+                    (!ids.count(categoryDTO.parentId) &&
+                     !categoryRepo_->findById(parentId))) {
+                    parentId.clear();
+                }
+            }
+
+            auto category = factory.restoreCategory(
+                id, stringToCategoryType(categoryDTO.type), text(categoryDTO.name),
+                text(categoryDTO.description), parentId);
+            if (categoryRepo_->findById(id)) {
+                categoryRepo_->update(category);
+                summary.categoriesUpdated++;
+            } else {
+                inserted.push_back(std::move(category));
+            }
         }
 
-        // Импорт операций
-        for (const auto& operationDTO : data.operations) {
+        categoryRepo_->saveAll(inserted);
+        summary.categoriesImported = inserted.size();
+        return ids;
+    }
+
+    // Операции с известным id обновляются; остальные сверяются с уже
+    // учтёнными (повторная или пересекающаяся выгрузка), новые создаются
+    // одним пакетом. Сохранение происходит, только если прошли проверку
+    // все строки
+    template <typename OperationRecord>
+    void importOperations(IEntityFactory& factory,
+                          const std::vector<OperationRecord>& operations,
+                          const IdMap& accountIds, const IdMap& categoryIds,
+                          ImportSummary& summary) {
+        // Ключ указывает в id операции, которую держит сама запись
+        std::unordered_map<std::string_view, std::shared_ptr<Operation>> existing;
+        std::vector<std::shared_ptr<Operation>> unmatched;
+        {
+            std::unordered_set<std::string_view> importedIds;
+            importedIds.reserve(operations.size());
+            for (const auto& operationDTO : operations) {
+                if (!operationDTO.id.empty()) importedIds.insert(operationDTO.id);
+            }
+            for (auto& operation : operationRepo_->findAll()) {
+                if (importedIds.count(operation->getId())) {
+                    existing.emplace(operation->getId(), std::move(operation));
+                } else {
+                    unmatched.push_back(std::move(operation));
+                }
+            }
+        }
+
+        // Строки, совпавшие с операциями из файла по id, не участвуют
+        // в поиске дубликатов: они заменяются напрямую
+        StatementMatcher matcher(unmatched);
+        OperationColumns columns;
+        columns.reserve(operations.size());
+        std::vector<bool> isUpdate;
+        isUpdate.reserve(operations.size());
+
+        for (const auto& operationDTO : operations) {
             auto type = stringToOperationType(operationDTO.type);
-            auto operation = factory->createOperation(
-                type,
-                operationDTO.bankAccountId,
-                Money(operationDTO.amount, operationDTO.currency),
-                operationDTO.categoryId,
-                operationDTO.description,
-                DateTimeUtils::fromString(operationDTO.date)
-            );
-            operationRepo_->save(operation);
+            Money amount(operationDTO.amount, text(operationDTO.currency));
+            auto date = operationDate(operationDTO);
+            Id accountId = remapReference(accountIds, operationDTO.bankAccountId);
+            std::string description(operationDTO.description);
+
+            bool update = existing.count(operationDTO.id) > 0;
+            if (!update) {
+                switch (matcher.match(accountId, type, amount, date,
+                                      description)) {
+                    case StatementMatcher::MatchKind::EXACT_DUPLICATE:
+                        summary.exactDuplicates++;
+                        continue;
+                    case StatementMatcher::MatchKind::FUZZY_DUPLICATE:
+                        summary.fuzzyDuplicates++;
+                        continue;
+                    case StatementMatcher::MatchKind::NEW:
+                        break;
+                }
+            }
+
+            Id id = Validator::checkId(operationDTO.id) == ErrorCode::NONE
+                        ? Id(operationDTO.id)
+                        : Id();
+            columns.add(std::move(id), type, std::move(accountId), amount,
+                        remapReference(categoryIds, operationDTO.categoryId),
+                        std::move(description), date);
+            isUpdate.push_back(update);
+        }
+
+        auto batch = factory.createOperations(std::move(columns));
+        if (!batch.rejected.empty()) {
+            const auto& first = batch.rejected.front();
+            throw ValidationException(
+                "Operation #" + std::to_string(first.row + 1) + ": " +
+                errorCodeToString(first.code) + " (" +
+                std::to_string(batch.rejected.size()) + " rejected)");
+        }
+
+        std::vector<std::shared_ptr<Operation>> inserted;
+        inserted.reserve(batch.created.size());
+        for (size_t i = 0; i < batch.created.size(); ++i) {
+            auto& operation = batch.created[i];
+            if (!isUpdate[i]) {
+                inserted.push_back(std::move(operation));
+                continue;
+            }
+            // Теги в файл не выгружаются, при замене они сохраняются
+            const auto& previous = existing[operation->getId()];
+            for (const auto& tag : previous->getTags()) {
+                operation->addTag(tag);
+            }
+            operationRepo_->update(operation);
+            if (budgetService_) {
+                budgetService_->revertExpense(*previous);
+                budgetService_->recordExpense(*operation);
+            }
+            summary.operationsUpdated++;
+        }
+
+        operationRepo_->saveAll(inserted);
+        summary.operationsImported = inserted.size();
+        // Импортированные расходы учитываются в бюджетах без проверки лимита
+        if (budgetService_) {
+            for (const auto& operation : inserted) {
+                budgetService_->recordExpense(*operation);
+            }
         }
     }
 };
@@ -43,6 +43,50 @@ public:
         return command->getCreatedCategory();
     }
 
+    // Создать подкатегорию того же типа, что и родитель
+    std::shared_ptr<Category> createSubcategory(
+        const Id& parentId,
+        const std::string& name,
+        const std::string& description = "") {
+
+        auto parent = getCategory(parentId);
+        if (!parent) {
+            throw EntityNotFoundException("Category", parentId);
+        }
+
+        auto command = std::make_shared<CreateCategoryCommand>(
+            parent->getType(), name, description, parentId);
+        auto decoratedCommand = DecoratedCommandFactory::decorate(command, decorationFlags_);
+        history_->execute(decoratedCommand);
+
+        return command->getCreatedCategory();
+    }
+
+    // Перенести категорию под другого родителя (пустой id — в корень)
+    void moveCategory(const Id& categoryId, const Id& newParentId) {
+        auto category = getCategory(categoryId);
+        if (!category) {
+            throw EntityNotFoundException("Category", categoryId);
+        }
+
+        if (!newParentId.empty()) {
+            auto parent = getCategory(newParentId);
+            if (!parent) {
+                throw EntityNotFoundException("Category", newParentId);
+            }
+            if (parent->getType() != category->getType()) {
+                throw ValidationException("Parent category must have the same type");
+            }
+            CategoryTree tree(categoryRepo_->findAll());
+            if (tree.wouldCreateCycle(categoryId, newParentId)) {
+                throw ValidationException("Category cannot be moved under its own subcategory");
+            }
+        }
+
+        category->setParentId(newParentId);
+        categoryRepo_->update(category);
+    }
+
     std::shared_ptr<Category> createIncomeCategory(
         const std::string& name,
         const std::string& description = "") {
@@ -101,13 +145,39 @@ public:
             throw DomainException("Невозможно удалить категорию с существующими операциями");
         }
 
-        if (categoryRepo_->findById(categoryId) == std::nullopt) {
+        auto category = categoryRepo_->findById(categoryId);
+        if (category == std::nullopt) {
             throw DomainException("Категории с таким ID не существует!");
         }
 
+        // Подкатегории переходят к родителю удаляемой категории.
+        // findAll отдаёт сохранённые версии, меняется их копия
+        for (const auto& child : categoryRepo_->findAll()) {
+            if (child->getParentId() == categoryId) {
+                auto moved = std::make_shared<Category>(*child);
+                moved->setParentId((*category)->getParentId());
+                categoryRepo_->update(moved);
+            }
+        }
+
         categoryRepo_->remove(categoryId);
     }
 
+    // Месячный бюджет категории
+    void setBudget(const Id& categoryId, double limit,
+                   BudgetPolicy policy = BudgetPolicy::WARN,
+                   const std::string& currency = "RUB") {
+        if (!getCategory(categoryId)) {
+            throw EntityNotFoundException("Category", categoryId);
+        }
+        ServiceLocator::get<BudgetService>()->setCategoryBudget(
+            categoryId, Money(limit, currency), policy);
+    }
+
+    std::optional<BudgetStatus> getBudgetStatus(const Id& categoryId) {
+        return ServiceLocator::get<BudgetService>()->getCategoryStatus(categoryId);
+    }
+
     // Создать стандартные категории
     void createDefaultCategories() {
         // Категории доходов
@@ -262,6 +332,31 @@ public:
         return operationRepo_->findByDateRange(range.getStart(), range.getEnd());
     }
 
+    // Теги операций
+    void tagOperation(const Id& operationId, const std::string& tag) {
+        auto operation = getOperation(operationId);
+        if (!operation) {
+            throw EntityNotFoundException("Operation", operationId);
+        }
+        if (operation->addTag(tag)) {
+            operationRepo_->update(operation);
+        }
+    }
+
+    void untagOperation(const Id& operationId, const std::string& tag) {
+        auto operation = getOperation(operationId);
+        if (!operation) {
+            throw EntityNotFoundException("Operation", operationId);
+        }
+        if (operation->removeTag(tag)) {
+            operationRepo_->update(operation);
+        }
+    }
+
+    std::vector<std::shared_ptr<Operation>> findByTags(const TagQuery& query) {
+        return operationRepo_->findByTags(query);
+    }
+
     // Управление операциями
     void updateOperation(const Id& operationId,
                         const Money& newAmount,
@@ -272,9 +367,11 @@ public:
         }
 
         // Обновить операцию
+        Money previousAmount = operation->getAmount();
         operation->setAmount(newAmount);
         operation->setDescription(newDescription);
         operationRepo_->update(operation);
+        ServiceLocator::get<BudgetService>()->updateExpense(*operation, previousAmount);
 
         // Пересчитать баланс счёта
         auto reconciliationService = ServiceLocator::get<BalanceReconciliationService>();
@@ -291,6 +388,7 @@ public:
 
         // Удалить операцию
         operationRepo_->remove(operationId);
+        ServiceLocator::get<BudgetService>()->revertExpense(*operation);
 
         // Пересчитать баланс счёта
         auto reconciliationService = ServiceLocator::get<BalanceReconciliationService>();
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+
+#include "common/epoch_reclamation.h"
+
+namespace financial {
+
+// Хеш-таблица с открытой адресацией (линейное пробирование) для
+// одновременной работы многих потоков. Слот хранит указатель на
+// неизменяемый узел {хеш, ключ, значение, жив}.
+//
+// Чтение идёт без блокировок: поиск — проход по соседним слотам
+// до пустого, узлы защищены EpochGuard. Запись — CAS по слоту: занятый
+// слот навсегда закреплён за своим ключом (удаление ставит на его место
+// узел-надгробие того же ключа), поэтому два писателя одного ключа
+// всегда встречаются в одном слоте. Писатели разных ключей друг друга
+// не ждут. Рост таблицы — единственная операция под исключительной
+// блокировкой: обычные писатели держат её в разделяемом режиме, а
+// читатели не берут вовсе. Надгробия пропадают при очередном росте.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ConcurrentHashMap {
+ private:
+  static constexpr size_t MIN_CAPACITY = 16;
+  // Доля занятых слотов (вместе с надгробиями), после которой таблица растёт
+  static constexpr size_t MAX_LOAD_PERCENT = 70;
+
+  struct Node {
+    size_t hash;
+    K key;
+    V value;
+    bool live;
+  };
+
+  struct Table {
+    size_t mask;
+    std::unique_ptr<std::atomic<Node*>[]> slots;
+    std::atomic<size_t> used{0};
+    // После роста живые узлы переходят в новую таблицу
+    bool ownsNodes = true;
+
+    explicit Table(size_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<Node*>[capacity]) {
+      for (size_t i = 0; i < capacity; ++i) slots[i] = nullptr;
+    }
+
+    ~Table() {
+      if (!ownsNodes) return;
+      for (size_t i = 0; i <= mask; ++i) {
+        delete slots[i].load(std::memory_order_relaxed);
+      }
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    bool overloaded() const {
+      return used.load(std::memory_order_relaxed) * 100 >
+             capacity() * MAX_LOAD_PERCENT;
+    }
+  };
+
+  enum class WriteMode { UPSERT, REPLACE, ERASE };
+  enum class WriteResult { INSERTED, REPLACED, ERASED, ABSENT, TABLE_FULL };
+
+  EpochDomain& domain_;
+  std::atomic<Table*> table_;
+  std::atomic<size_t> size_{0};
+  mutable std::shared_mutex resizeMutex_;
+  Hash hasher_;
+
+ public:
+  explicit ConcurrentHashMap(size_t capacity = MIN_CAPACITY,
+                             EpochDomain& domain = EpochDomain::global())
+      : domain_(domain), table_(new Table(capacityFor(capacity))) {}
+
+  ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+  ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+  ~ConcurrentHashMap() { delete table_.load(std::memory_order_relaxed); }
+
+  // --- чтение, без блокировок ---
+
+  std::optional<V> find(const K& key) const {
+    EpochGuard guard(domain_);
+    size_t hash = hasher_(key);
+    const Table* table = table_.load(std::memory_order_acquire);
+    for (size_t probe = 0, i = hash & table->mask; probe <= table->mask;
+         ++probe, i = (i + 1) & table->mask) {
+      const Node* node = table->slots[i].load(std::memory_order_acquire);
+      if (!node) break;
+      if (node->hash == hash && node->key == key) {
+        if (node->live) return node->value;
+        break;
+      }
+    }
+    return std::nullopt;
+  }
+
+  bool contains(const K& key) const { return find(key).has_value(); }
+
+  size_t size() const { return size_.load(std::memory_order_acquire); }
+  bool empty() const { return size() == 0; }
+
+  // Обход без блокировки: видны все записи, завершённые до начала
+  // обхода; параллельные изменения могут попасть или не попасть
+  template <typename Fn>
+  void forEach(Fn fn) const {
+    EpochGuard guard(domain_);
+    const Table* table = table_.load(std::memory_order_acquire);
+    for (size_t i = 0; i <= table->mask; ++i) {
+      const Node* node = table->slots[i].load(std::memory_order_acquire);
+      if (node && node->live) fn(node->key, node->value);
+    }
+  }
+
+  // --- запись ---
+
+  // true, если ключа не было
+  bool insertOrAssign(const K& key, V value) {
+    return write(key, std::move(value), WriteMode::UPSERT) ==
+           WriteResult::INSERTED;
+  }
+
+  // Заменить значение существующего ключа; false, если ключа нет
+  bool replace(const K& key, V value) {
+    return write(key, std::move(value), WriteMode::REPLACE) ==
+           WriteResult::REPLACED;
+  }
+
+  bool erase(const K& key) {
+    return write(key, V{}, WriteMode::ERASE) == WriteResult::ERASED;
+  }
+
+  void reserve(size_t count) {
+    std::unique_lock<std::shared_mutex> lock(resizeMutex_);
+    Table* table = table_.load(std::memory_order_relaxed);
+    if (capacityFor(count) > table->capacity()) rehashLocked(count);
+  }
+
+  void clear() {
+    std::unique_lock<std::shared_mutex> lock(resizeMutex_);
+    Table* old =
+        table_.exchange(new Table(MIN_CAPACITY), std::memory_order_acq_rel);
+    size_.store(0, std::memory_order_release);
+    domain_.retire(old);
+  }
+
+ private:
+  // Вместимость — степень двойки, при которой count ключей не
+  // превышают допустимой загрузки
+  static size_t capacityFor(size_t count) {
+    size_t capacity = MIN_CAPACITY;
+    while (count * 100 > capacity * MAX_LOAD_PERCENT) capacity *= 2;
+    return capacity;
+  }
+
+  WriteResult write(const K& key, V value, WriteMode mode) {
+    size_t hash = hasher_(key);
+    auto* node = new Node{hash, key, std::move(value), mode != WriteMode::ERASE};
+    while (true) {
+      WriteResult result;
+      bool grow;
+      {
+        std::shared_lock<std::shared_mutex> lock(resizeMutex_);
+        EpochGuard guard(domain_);
+        Table* table = table_.load(std::memory_order_acquire);
+        result = writeToTable(*table, node, mode);
+        grow = result == WriteResult::TABLE_FULL || table->overloaded();
+      }
+      if (grow) growIfNeeded();
+      if (result != WriteResult::TABLE_FULL) {
+        if (result == WriteResult::ABSENT) delete node;
+        return result;
+      }
+    }
+  }
+
+  // node либо публикуется в таблице, либо остаётся у вызывающего
+  // (ABSENT, TABLE_FULL)
+  WriteResult writeToTable(Table& table, Node* node, WriteMode mode) {
+    for (size_t probe = 0, i = node->hash & table.mask; probe <= table.mask;
+         ++probe, i = (i + 1) & table.mask) {
+      std::atomic<Node*>& slot = table.slots[i];
+      Node* current = slot.load(std::memory_order_acquire);
+
+      if (!current) {
+        if (mode != WriteMode::UPSERT) return WriteResult::ABSENT;
+        if (slot.compare_exchange_strong(current, node,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+          table.used.fetch_add(1, std::memory_order_relaxed);
+          size_.fetch_add(1, std::memory_order_acq_rel);
+          return WriteResult::INSERTED;
+        }
+        // Слот заняли раньше нас: current — узел победителя
+      }
+
+      if (current->hash != node->hash || !(current->key == node->key)) {
+        continue;
+      }
+
+      // Слот нашего ключа: дальше меняется только узел в нём
+      while (true) {
+        if (mode != WriteMode::UPSERT && !current->live) {
+          return WriteResult::ABSENT;
+        }
+        if (slot.compare_exchange_weak(current, node,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+          bool wasLive = current->live;
+          domain_.retire(current);
+          if (mode == WriteMode::ERASE) {
+            size_.fetch_sub(1, std::memory_order_acq_rel);
+            return WriteResult::ERASED;
+          }
+          if (wasLive) return WriteResult::REPLACED;
+          size_.fetch_add(1, std::memory_order_acq_rel);
+          return WriteResult::INSERTED;
+        }
+      }
+    }
+    return mode == WriteMode::UPSERT ? WriteResult::TABLE_FULL
+                                     : WriteResult::ABSENT;
+  }
+
+  void growIfNeeded() {
+    std::unique_lock<std::shared_mutex> lock(resizeMutex_);
+    Table* table = table_.load(std::memory_order_relaxed);
+    if (table->overloaded() || table->used.load(std::memory_order_relaxed) >=
+                                   table->capacity()) {
+      rehashLocked(size_.load(std::memory_order_relaxed) * 2);
+    }
+  }
+
+  // Под исключительной блокировкой: писателей нет, читатели могут
+  // продолжать обход старой таблицы, поэтому узлы не меняются, а
+  // только переносятся; надгробия освобождаются через домен
+  void rehashLocked(size_t count) {
+    Table* old = table_.load(std::memory_order_relaxed);
+    auto* table = new Table(capacityFor(count));
+    for (size_t i = 0; i <= old->mask; ++i) {
+      Node* node = old->slots[i].load(std::memory_order_relaxed);
+      if (!node) continue;
+      if (!node->live) {
+        domain_.retire(node);
+        continue;
+      }
+      size_t j = node->hash & table->mask;
+      while (table->slots[j].load(std::memory_order_relaxed)) {
+        j = (j + 1) & table->mask;
+      }
+      table->slots[j].store(node, std::memory_order_relaxed);
+      table->used.fetch_add(1, std::memory_order_relaxed);
+    }
+    old->ownsNodes = false;
+    table_.store(table, std::memory_order_release);
+    domain_.retire(old);
+  }
+};
+
+}  // namespace financial
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace financial {
+
+// Отложенное освобождение памяти по эпохам (EBR) для структур,
+// которые читаются без блокировок. Читатель на время обхода
+// "закрепляется" в текущей эпохе (EpochGuard). Писатель, исключив узел
+// из структуры, не удаляет его сразу, а передаёт в retire() с номером
+// эпохи. Узел освобождается, когда все закреплённые читатели ушли
+// в более позднюю эпоху: ни один из них уже не мог его увидеть.
+//
+// Закрепление — один CAS по слоту из фиксированного массива, без
+// регистрации потоков. Слот выбирается по хешу потока; если все слоты
+// заняты, читатель ждёт освобождения любого из них.
+class EpochDomain {
+ public:
+  static constexpr size_t SLOTS = 256;
+  // Сколько отложенных узлов накопить перед попыткой освобождения
+  static constexpr size_t RECLAIM_THRESHOLD = 64;
+
+ private:
+  static constexpr uint64_t IDLE = std::numeric_limits<uint64_t>::max();
+
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch{IDLE};
+  };
+
+  struct Retired {
+    uint64_t epoch;
+    void* pointer;
+    void (*deleter)(void*);
+  };
+
+  std::atomic<uint64_t> globalEpoch_{1};
+  Slot slots_[SLOTS];
+
+  std::mutex retiredMutex_;
+  std::vector<Retired> retired_;
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> collectAt_{RECLAIM_THRESHOLD};
+
+ public:
+  EpochDomain() = default;
+  EpochDomain(const EpochDomain&) = delete;
+  EpochDomain& operator=(const EpochDomain&) = delete;
+
+  // Читателей к моменту разрушения быть не должно
+  ~EpochDomain() {
+    for (const auto& item : retired_) item.deleter(item.pointer);
+  }
+
+  // Общий домен процесса: узлы разных структур освобождаются вместе
+  static EpochDomain& global() {
+    static EpochDomain domain;
+    return domain;
+  }
+
+  class Guard {
+   private:
+    Slot* slot_;
+
+   public:
+    explicit Guard(EpochDomain& domain) : slot_(domain.pin()) {}
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+    ~Guard() { slot_->epoch.store(IDLE, std::memory_order_release); }
+  };
+
+  Guard guard() { return Guard(*this); }
+
+  // Узел уже недостижим для новых читателей; удалить, когда уйдут старые
+  template <typename T>
+  void retire(T* pointer) {
+    retire(pointer, [](void* p) { delete static_cast<T*>(p); });
+  }
+
+  void retire(void* pointer, void (*deleter)(void*)) {
+    {
+      std::lock_guard<std::mutex> lock(retiredMutex_);
+      retired_.push_back(
+          {globalEpoch_.load(std::memory_order_seq_cst), pointer, deleter});
+    }
+    if (pending_.fetch_add(1, std::memory_order_relaxed) + 1 >=
+        collectAt_.load(std::memory_order_relaxed)) {
+      collect();
+    }
+  }
+
+  // Сдвинуть эпоху, если все читатели её уже видели, и освободить
+  // узлы, которые никто из закреплённых читателей не может держать.
+  // Возвращает число освобождённых узлов
+  size_t collect() {
+    std::vector<Retired> ready;
+    {
+      std::lock_guard<std::mutex> lock(retiredMutex_);
+      uint64_t current = globalEpoch_.load(std::memory_order_seq_cst);
+      uint64_t oldest = oldestPinned();
+      if (oldest == IDLE || oldest == current) {
+        globalEpoch_.compare_exchange_strong(current, current + 1,
+                                             std::memory_order_seq_cst);
+        oldest = std::min(oldestPinned(), current + 1);
+      }
+
+      auto keep = std::partition(
+          retired_.begin(), retired_.end(),
+          [oldest](const Retired& item) { return item.epoch >= oldest; });
+      ready.assign(keep, retired_.end());
+      retired_.erase(keep, retired_.end());
+      pending_.store(retired_.size(), std::memory_order_relaxed);
+      // Если долгий читатель держит эпоху, список не сокращается;
+      // следующая попытка — когда он вырастет вдвое, иначе каждая
+      // отложенная запись стоила бы прохода по всему списку
+      collectAt_.store(std::max(RECLAIM_THRESHOLD, retired_.size() * 2),
+                       std::memory_order_relaxed);
+    }
+    // Деструкторы узлов вызываются без блокировки домена
+    for (const auto& item : ready) item.deleter(item.pointer);
+    return ready.size();
+  }
+
+  size_t pendingCount() const {
+    return pending_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t currentEpoch() const {
+    return globalEpoch_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  Slot* pin() {
+    size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    while (true) {
+      for (size_t i = 0; i < SLOTS; ++i) {
+        Slot& slot = slots_[(start + i) % SLOTS];
+        uint64_t expected = IDLE;
+        // seq_cst: запись слота упорядочена перед любым чтением
+        // структуры, а collect() видит либо слот, либо уже новое
+        // состояние структуры
+        uint64_t epoch = globalEpoch_.load(std::memory_order_seq_cst);
+        if (slot.epoch.load(std::memory_order_relaxed) == IDLE &&
+            slot.epoch.compare_exchange_strong(expected, epoch,
+                                               std::memory_order_seq_cst)) {
+          return &slot;
+        }
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  uint64_t oldestPinned() const {
+    uint64_t oldest = IDLE;
+    for (const auto& slot : slots_) {
+      oldest = std::min(oldest, slot.epoch.load(std::memory_order_seq_cst));
+    }
+    return oldest;
+  }
+};
+
+using EpochGuard = EpochDomain::Guard;
+
+}  // namespace financial
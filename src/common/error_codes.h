@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <variant>
+
+#include "types.h"
+
+namespace financial {
+
+// Компактные коды ошибок для путей без исключений.
+// Отказ в проводке (овердрафт, неверный id) — штатная ситуация при пакетной
+// обработке, поэтому горячие пути возвращают код вместо раскрутки стека
+// и сборки строки сообщения.
+enum class ErrorCode : uint8_t {
+  NONE = 0,
+  EMPTY_VALUE,
+  NOT_POSITIVE,
+  NEGATIVE_VALUE,
+  OUT_OF_RANGE,
+  TOO_LONG,
+  INVALID_ID,
+  INVALID_FORMAT,
+  CURRENCY_MISMATCH,
+  INACTIVE_ACCOUNT,
+  INSUFFICIENT_FUNDS,
+  SAME_ACCOUNT,
+  ACCOUNT_NOT_FOUND,
+  BUDGET_EXCEEDED,
+  DUPLICATE_ID,
+  UNKNOWN_REFERENCE
+};
+
+inline const char* errorCodeToString(ErrorCode code) {
+  switch (code) {
+    case ErrorCode::NONE: return "NONE";
+    case ErrorCode::EMPTY_VALUE: return "EMPTY_VALUE";
+    case ErrorCode::NOT_POSITIVE: return "NOT_POSITIVE";
+    case ErrorCode::NEGATIVE_VALUE: return "NEGATIVE_VALUE";
+    case ErrorCode::OUT_OF_RANGE: return "OUT_OF_RANGE";
+    case ErrorCode::TOO_LONG: return "TOO_LONG";
+    case ErrorCode::INVALID_ID: return "INVALID_ID";
+    case ErrorCode::INVALID_FORMAT: return "INVALID_FORMAT";
+    case ErrorCode::CURRENCY_MISMATCH: return "CURRENCY_MISMATCH";
+    case ErrorCode::INACTIVE_ACCOUNT: return "INACTIVE_ACCOUNT";
+    case ErrorCode::INSUFFICIENT_FUNDS: return "INSUFFICIENT_FUNDS";
+    case ErrorCode::SAME_ACCOUNT: return "SAME_ACCOUNT";
+    case ErrorCode::ACCOUNT_NOT_FOUND: return "ACCOUNT_NOT_FOUND";
+    case ErrorCode::BUDGET_EXCEEDED: return "BUDGET_EXCEEDED";
+    case ErrorCode::DUPLICATE_ID: return "DUPLICATE_ID";
+    case ErrorCode::UNKNOWN_REFERENCE: return "UNKNOWN_REFERENCE";
+    default: return "UNKNOWN";
+  }
+}
+
+// Результат операции без возвращаемого значения
+using Status = Result<std::monostate, ErrorCode>;
+
+inline Status okStatus() { return Status::success(std::monostate{}); }
+
+inline Status errorStatus(ErrorCode code) { return Status::failure(code); }
+
+}  // namespace financial
@@ -39,6 +39,13 @@ namespace financial {
                               ", Available: " + std::to_string(available)) {}
     };
 
+    class BudgetExceededException : public DomainException {
+    public:
+        explicit BudgetExceededException(const std::string& scope, double limit, double spent)
+            : DomainException("Budget exceeded for " + scope + ". Limit: " + std::to_string(limit) +
+                              ", Month-to-date: " + std::to_string(spent)) {}
+    };
+
     // Ошибки в инфраструктуре
     class InfrastructureException : public FinancialException {
     public:
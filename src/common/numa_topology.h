@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace financial {
+
+// Узлы NUMA машины и их процессоры. Топология читается из sysfs
+// (/sys/devices/system/node), без зависимости от libnuma; если sysfs
+// недоступен или узел один, вся машина считается одним узлом.
+//
+// Память, которую поток, привязанный к узлу, трогает первым, ядро
+// выделяет на этом же узле (first touch), поэтому состояние, созданное
+// задачей на рабочем своего узла (ThreadPool::postToNode), оказывается
+// локальным для узла.
+class NumaTopology {
+ public:
+  struct Node {
+    int id;
+    std::vector<int> cpus;
+  };
+
+ private:
+  std::vector<Node> nodes_;
+
+ public:
+  explicit NumaTopology(std::vector<Node> nodes) : nodes_(std::move(nodes)) {
+    if (nodes_.empty()) nodes_ = singleNode().nodes_;
+  }
+
+  // Один узел со всеми процессорами; CPU не перечисляются — поток
+  // не привязывается
+  static NumaTopology singleNode() {
+    return NumaTopology(std::vector<Node>{Node{0, {}}});
+  }
+
+  static NumaTopology detect(
+      const std::string& sysfsRoot = "/sys/devices/system/node") {
+    std::vector<Node> nodes;
+    for (int id : parseCpuList(readFile(sysfsRoot + "/online"))) {
+      std::vector<int> cpus = parseCpuList(
+          readFile(sysfsRoot + "/node" + std::to_string(id) + "/cpulist"));
+      // Узлы только с памятью потоки не исполняют
+      if (!cpus.empty()) nodes.push_back(Node{id, std::move(cpus)});
+    }
+    return NumaTopology(std::move(nodes));
+  }
+
+  // Топология машины, определяется один раз
+  static const NumaTopology& system() {
+    static const NumaTopology topology = detect();
+    return topology;
+  }
+
+  size_t nodeCount() const { return nodes_.size(); }
+  bool isNuma() const { return nodes_.size() > 1; }
+  const std::vector<Node>& nodes() const { return nodes_; }
+
+  size_t nodeForHash(size_t hash) const { return hash % nodes_.size(); }
+
+  // "0-3,8,10-11" -> {0,1,2,3,8,10,11}; формат cpulist и online
+  static std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> result;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+      range.erase(std::remove_if(range.begin(), range.end(),
+                                 [](char c) { return c == ' ' || c == '\n'; }),
+                  range.end());
+      if (range.empty()) continue;
+      try {
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos
+                       ? first
+                       : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) result.push_back(cpu);
+      } catch (const std::exception&) {
+        return {};
+      }
+    }
+    return result;
+  }
+
+  // Привязать текущий поток к процессорам узла; false — не удалось
+  // или привязка не поддерживается
+  bool pinCurrentThread(size_t node) const {
+#ifdef __linux__
+    const auto& cpus = nodes_.at(node).cpus;
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+  }
+
+ private:
+  static std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return {};
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+  }
+};
+
+}  // namespace financial
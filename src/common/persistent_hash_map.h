@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace financial {
+
+// Неизменяемое хеш-отображение (HAMT, раскладка узлов как в CHAMP).
+// Каждый узел ветвится на 32 направления по очередным 5 битам хеша;
+// битовые карты dataMap и nodeMap говорят, какие направления заняты
+// значением, а какие — вложенным узлом, и массивы хранятся плотно.
+// Вставка и удаление копируют только путь от корня до изменённого
+// узла (не больше 13 узлов), остальное дерево разделяется со старой
+// версией. Поэтому копия отображения — снимок — стоит O(1) и никогда
+// не меняется. Полное совпадение 64-битных хешей разрешается узлом
+// коллизий с линейным поиском.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class PersistentHashMap {
+ private:
+  static constexpr unsigned BITS = 5;
+  static constexpr unsigned HASH_BITS = 64;
+
+  struct Entry {
+    uint64_t hash;
+    K key;
+    V value;
+  };
+
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+
+  struct Node {
+    uint32_t dataMap = 0;
+    uint32_t nodeMap = 0;
+    std::vector<Entry> entries;
+    std::vector<NodePtr> nodes;
+  };
+
+  NodePtr root_;
+  size_t size_ = 0;
+
+  PersistentHashMap(NodePtr root, size_t size)
+      : root_(std::move(root)), size_(size) {}
+
+ public:
+  PersistentHashMap() = default;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const V* find(const K& key) const {
+    uint64_t hash = hashOf(key);
+    const Node* node = root_.get();
+    for (unsigned shift = 0; node; shift += BITS) {
+      if (shift >= HASH_BITS) {
+        for (const auto& entry : node->entries) {
+          if (entry.key == key) return &entry.value;
+        }
+        return nullptr;
+      }
+      uint32_t bit = bitFor(hash, shift);
+      if (node->dataMap & bit) {
+        const Entry& entry = node->entries[indexOf(node->dataMap, bit)];
+        return entry.hash == hash && entry.key == key ? &entry.value
+                                                      : nullptr;
+      }
+      if (!(node->nodeMap & bit)) return nullptr;
+      node = node->nodes[indexOf(node->nodeMap, bit)].get();
+    }
+    return nullptr;
+  }
+
+  bool contains(const K& key) const { return find(key) != nullptr; }
+
+  // Новая версия с key -> value; текущая не меняется
+  PersistentHashMap insert(const K& key, V value) const {
+    Entry entry{hashOf(key), key, std::move(value)};
+    if (!root_) return PersistentHashMap(leaf(std::move(entry)), 1);
+
+    bool added = false;
+    NodePtr root = insert(*root_, std::move(entry), 0, added);
+    return PersistentHashMap(std::move(root), size_ + (added ? 1 : 0));
+  }
+
+  PersistentHashMap erase(const K& key) const {
+    if (!root_) return *this;
+    bool removed = false;
+    NodePtr root = erase(*root_, hashOf(key), key, 0, removed);
+    if (!removed) return *this;
+    return PersistentHashMap(std::move(root), size_ - 1);
+  }
+
+  template <typename Fn>
+  void forEach(Fn fn) const {
+    if (root_) forEach(*root_, fn);
+  }
+
+ private:
+  static uint64_t hashOf(const K& key) {
+    return static_cast<uint64_t>(Hash{}(key));
+  }
+
+  static uint32_t bitFor(uint64_t hash, unsigned shift) {
+    return uint32_t{1} << ((hash >> shift) & 31);
+  }
+
+  static size_t indexOf(uint32_t map, uint32_t bit) {
+    return static_cast<size_t>(__builtin_popcount(map & (bit - 1)));
+  }
+
+  static NodePtr leaf(Entry entry) {
+    auto node = std::make_shared<Node>();
+    node->dataMap = bitFor(entry.hash, 0);
+    node->entries.push_back(std::move(entry));
+    return node;
+  }
+
+  // Узел из двух значений, разошедшихся не выше уровня shift
+  static NodePtr mergeTwo(Entry a, Entry b, unsigned shift) {
+    auto node = std::make_shared<Node>();
+    if (shift >= HASH_BITS) {
+      node->entries.push_back(std::move(a));
+      node->entries.push_back(std::move(b));
+      return node;
+    }
+    uint32_t bitA = bitFor(a.hash, shift);
+    uint32_t bitB = bitFor(b.hash, shift);
+    if (bitA == bitB) {
+      node->nodeMap = bitA;
+      node->nodes.push_back(mergeTwo(std::move(a), std::move(b), shift + BITS));
+      return node;
+    }
+    node->dataMap = bitA | bitB;
+    if (bitA < bitB) {
+      node->entries.push_back(std::move(a));
+      node->entries.push_back(std::move(b));
+    } else {
+      node->entries.push_back(std::move(b));
+      node->entries.push_back(std::move(a));
+    }
+    return node;
+  }
+
+  static NodePtr insert(const Node& node, Entry entry, unsigned shift,
+                        bool& added) {
+    auto copy = std::make_shared<Node>(node);
+    if (shift >= HASH_BITS) {
+      for (auto& existing : copy->entries) {
+        if (existing.key == entry.key) {
+          existing.value = std::move(entry.value);
+          return copy;
+        }
+      }
+      copy->entries.push_back(std::move(entry));
+      added = true;
+      return copy;
+    }
+
+    uint32_t bit = bitFor(entry.hash, shift);
+    if (node.dataMap & bit) {
+      size_t index = indexOf(node.dataMap, bit);
+      Entry& existing = copy->entries[index];
+      if (existing.hash == entry.hash && existing.key == entry.key) {
+        existing.value = std::move(entry.value);
+        return copy;
+      }
+      // Два значения в одном направлении — уходят во вложенный узел
+      NodePtr child =
+          mergeTwo(std::move(existing), std::move(entry), shift + BITS);
+      copy->entries.erase(copy->entries.begin() + index);
+      copy->dataMap &= ~bit;
+      copy->nodeMap |= bit;
+      copy->nodes.insert(copy->nodes.begin() + indexOf(copy->nodeMap, bit),
+                         std::move(child));
+      added = true;
+      return copy;
+    }
+
+    if (node.nodeMap & bit) {
+      NodePtr& child = copy->nodes[indexOf(node.nodeMap, bit)];
+      child = insert(*child, std::move(entry), shift + BITS, added);
+      return copy;
+    }
+
+    copy->dataMap |= bit;
+    copy->entries.insert(copy->entries.begin() + indexOf(copy->dataMap, bit),
+                         std::move(entry));
+    added = true;
+    return copy;
+  }
+
+  // nullptr — узел опустел. Узел с единственным значением поднимается
+  // в родителя, так что форма дерева не зависит от истории удалений
+  static NodePtr erase(const Node& node, uint64_t hash, const K& key,
+                       unsigned shift, bool& removed) {
+    if (shift >= HASH_BITS) {
+      for (size_t i = 0; i < node.entries.size(); ++i) {
+        if (node.entries[i].key != key) continue;
+        removed = true;
+        if (node.entries.size() == 1) return nullptr;
+        auto copy = std::make_shared<Node>(node);
+        copy->entries.erase(copy->entries.begin() + i);
+        return copy;
+      }
+      return nullptr;
+    }
+
+    uint32_t bit = bitFor(hash, shift);
+    if (node.dataMap & bit) {
+      size_t index = indexOf(node.dataMap, bit);
+      const Entry& entry = node.entries[index];
+      if (entry.hash != hash || entry.key != key) return nullptr;
+      removed = true;
+      if (node.entries.size() == 1 && node.nodes.empty()) return nullptr;
+      auto copy = std::make_shared<Node>(node);
+      copy->entries.erase(copy->entries.begin() + index);
+      copy->dataMap &= ~bit;
+      return copy;
+    }
+
+    if (!(node.nodeMap & bit)) return nullptr;
+    size_t index = indexOf(node.nodeMap, bit);
+    NodePtr child = erase(*node.nodes[index], hash, key, shift + BITS, removed);
+    if (!removed) return nullptr;
+
+    auto copy = std::make_shared<Node>(node);
+    bool inlineChild =
+        child && child->nodes.empty() && child->entries.size() == 1;
+    if (child && !inlineChild) {
+      copy->nodes[index] = std::move(child);
+      return copy;
+    }
+
+    copy->nodes.erase(copy->nodes.begin() + index);
+    copy->nodeMap &= ~bit;
+    if (inlineChild) {
+      copy->dataMap |= bit;
+      copy->entries.insert(copy->entries.begin() + indexOf(copy->dataMap, bit),
+                           child->entries.front());
+    }
+    if (copy->entries.empty() && copy->nodes.empty()) return nullptr;
+    return copy;
+  }
+
+  template <typename Fn>
+  static void forEach(const Node& node, Fn& fn) {
+    for (const auto& entry : node.entries) fn(entry.key, entry.value);
+    for (const auto& child : node.nodes) forEach(*child, fn);
+  }
+};
+
+}  // namespace financial
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "exceptions.h"
+
+namespace financial {
+
+// Столбец гистограммы распределения сумм
+struct HistogramBin {
+  double lowerBound;
+  double upperBound;
+  uint64_t count;
+};
+
+// Квантильный скетч с логарифмическими корзинами (по мотивам DDSketch).
+// Значение x попадает в корзину ceil(log_gamma(x)), поэтому любой квантиль
+// восстанавливается с относительной погрешностью не более relativeAccuracy.
+// Вставка O(1), скетчи с одинаковой точностью складываются через merge(),
+// что позволяет считать их по частям и поддерживать инкрементально.
+class QuantileSketch {
+ private:
+  static constexpr double MIN_INDEXABLE_VALUE = 1e-9;
+
+  double relativeAccuracy_;
+  double gamma_;
+  double logGamma_;
+
+  // Плотный массив счётчиков, counts_[i] соответствует корзине minIndex_ + i
+  std::vector<uint64_t> counts_;
+  int minIndex_ = 0;
+  uint64_t zeroCount_ = 0;
+
+  uint64_t count_ = 0;
+  double sum_ = 0.0;
+  double min_ = std::numeric_limits<double>::infinity();
+  double max_ = -std::numeric_limits<double>::infinity();
+
+ public:
+  explicit QuantileSketch(double relativeAccuracy = 0.01)
+      : relativeAccuracy_(relativeAccuracy),
+        gamma_((1 + relativeAccuracy) / (1 - relativeAccuracy)),
+        logGamma_(std::log(gamma_)) {
+    if (relativeAccuracy <= 0 || relativeAccuracy >= 1) {
+      throw ValidationException("Relative accuracy must be in (0, 1)");
+    }
+  }
+
+  void add(double value, uint64_t weight = 1) {
+    if (weight == 0) return;
+
+    if (value <= MIN_INDEXABLE_VALUE) {
+      zeroCount_ += weight;
+    } else {
+      bucketAt(indexOf(value)) += weight;
+    }
+
+    count_ += weight;
+    sum_ += value * static_cast<double>(weight);
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  // Объединить с другим скетчем той же точности
+  void merge(const QuantileSketch& other) {
+    if (gamma_ != other.gamma_) {
+      throw ValidationException(
+          "Cannot merge sketches with different accuracy");
+    }
+    if (other.count_ == 0) return;
+
+    for (size_t i = 0; i < other.counts_.size(); ++i) {
+      if (other.counts_[i] != 0) {
+        bucketAt(other.minIndex_ + static_cast<int>(i)) += other.counts_[i];
+      }
+    }
+
+    zeroCount_ += other.zeroCount_;
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  // Квантиль q из [0, 1]
+  double quantile(double q) const {
+    if (count_ == 0) return 0.0;
+    if (q <= 0) return min_;
+    if (q >= 1) return max_;
+
+    double rank = q * static_cast<double>(count_ - 1);
+    double cumulative = static_cast<double>(zeroCount_);
+    if (cumulative > rank) return std::max(min_, 0.0);
+
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      cumulative += static_cast<double>(counts_[i]);
+      if (cumulative > rank) {
+        return std::clamp(valueOf(minIndex_ + static_cast<int>(i)), min_,
+                          max_);
+      }
+    }
+    return max_;
+  }
+
+  double median() const { return quantile(0.5); }
+
+  // Гистограмма с равными по ширине столбцами на [min, max].
+  // Строится по корзинам скетча, без обращения к исходным значениям.
+  std::vector<HistogramBin> histogram(size_t binCount) const {
+    std::vector<HistogramBin> bins;
+    if (count_ == 0 || binCount == 0) return bins;
+
+    double width = (max_ - min_) / static_cast<double>(binCount);
+    bins.reserve(binCount);
+    for (size_t i = 0; i < binCount; ++i) {
+      bins.push_back({min_ + width * static_cast<double>(i),
+                      min_ + width * static_cast<double>(i + 1), 0});
+    }
+
+    auto binOf = [&](double value) -> size_t {
+      if (width <= 0) return 0;
+      auto idx = static_cast<size_t>((value - min_) / width);
+      return std::min(idx, binCount - 1);
+    };
+
+    if (zeroCount_ != 0) bins[binOf(std::max(min_, 0.0))].count += zeroCount_;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      if (counts_[i] == 0) continue;
+      double value =
+          std::clamp(valueOf(minIndex_ + static_cast<int>(i)), min_, max_);
+      bins[binOf(value)].count += counts_[i];
+    }
+    return bins;
+  }
+
+  uint64_t count() const { return count_; }
+  double sum() const { return sum_; }
+  double mean() const {
+    return count_ > 0 ? sum_ / static_cast<double>(count_) : 0.0;
+  }
+  double min() const { return count_ > 0 ? min_ : 0.0; }
+  double max() const { return count_ > 0 ? max_ : 0.0; }
+  double relativeAccuracy() const { return relativeAccuracy_; }
+  bool empty() const { return count_ == 0; }
+
+ private:
+  int indexOf(double value) const {
+    return static_cast<int>(std::ceil(std::log(value) / logGamma_));
+  }
+
+  // Представитель корзины: середина интервала (gamma^(i-1), gamma^i]
+  double valueOf(int index) const {
+    return 2 * std::pow(gamma_, index) / (gamma_ + 1);
+  }
+
+  uint64_t& bucketAt(int index) {
+    if (counts_.empty()) {
+      minIndex_ = index;
+      counts_.push_back(0);
+    } else if (index < minIndex_) {
+      counts_.insert(counts_.begin(), static_cast<size_t>(minIndex_ - index),
+                     0);
+      minIndex_ = index;
+    } else if (index >= minIndex_ + static_cast<int>(counts_.size())) {
+      counts_.resize(static_cast<size_t>(index - minIndex_) + 1, 0);
+    }
+    return counts_[static_cast<size_t>(index - minIndex_)];
+  }
+};
+
+}  // namespace financial
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace financial {
+
+// Сжатое множество 32-битных ключей (по мотивам Roaring Bitmap).
+// Ключ делится на старшие 16 бит — номер контейнера — и младшие 16 бит.
+// Разреженный контейнер хранит отсортированный массив младших частей,
+// плотный (больше ARRAY_LIMIT элементов) — битовую карту на 65536 бит.
+// Пересечение, объединение и разность выполняются по парам контейнеров
+// с одинаковым номером ядром, подобранным под их представление.
+class RoaringBitmap {
+ private:
+  static constexpr uint32_t ARRAY_LIMIT = 4096;
+  static constexpr size_t BITMAP_WORDS = 65536 / 64;
+
+  struct Container {
+    uint16_t key = 0;
+    uint32_t cardinality = 0;
+    std::vector<uint16_t> array;  // разреженное представление
+    std::vector<uint64_t> bits;   // плотное представление
+
+    bool isBitmap() const { return !bits.empty(); }
+
+    bool contains(uint16_t low) const {
+      if (isBitmap()) return (bits[low >> 6] >> (low & 63)) & 1;
+      return std::binary_search(array.begin(), array.end(), low);
+    }
+
+    bool add(uint16_t low) {
+      if (isBitmap()) {
+        uint64_t mask = uint64_t{1} << (low & 63);
+        if (bits[low >> 6] & mask) return false;
+        bits[low >> 6] |= mask;
+      } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (it != array.end() && *it == low) return false;
+        array.insert(it, low);
+        if (array.size() > ARRAY_LIMIT) toBitmap();
+      }
+      cardinality++;
+      return true;
+    }
+
+    bool remove(uint16_t low) {
+      if (isBitmap()) {
+        uint64_t mask = uint64_t{1} << (low & 63);
+        if (!(bits[low >> 6] & mask)) return false;
+        bits[low >> 6] &= ~mask;
+        cardinality--;
+        if (cardinality <= ARRAY_LIMIT) toArray();
+      } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (it == array.end() || *it != low) return false;
+        array.erase(it);
+        cardinality--;
+      }
+      return true;
+    }
+
+    void toBitmap() {
+      bits.assign(BITMAP_WORDS, 0);
+      for (uint16_t low : array) bits[low >> 6] |= uint64_t{1} << (low & 63);
+      array.clear();
+      array.shrink_to_fit();
+    }
+
+    void toArray() {
+      array.clear();
+      array.reserve(cardinality);
+      forEachBit([this](uint16_t low) { array.push_back(low); });
+      bits.clear();
+      bits.shrink_to_fit();
+    }
+
+    // После пословной операции: пересчитать мощность и выбрать представление
+    void normalizeBitmap() {
+      cardinality = 0;
+      for (uint64_t word : bits) cardinality += popcount(word);
+      if (cardinality <= ARRAY_LIMIT) toArray();
+    }
+
+    template <typename Fn>
+    void forEachBit(Fn fn) const {
+      for (size_t w = 0; w < bits.size(); ++w) {
+        uint64_t word = bits[w];
+        while (word != 0) {
+          fn(static_cast<uint16_t>(w * 64 + countTrailingZeros(word)));
+          word &= word - 1;
+        }
+      }
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) const {
+      if (isBitmap()) {
+        forEachBit(fn);
+      } else {
+        for (uint16_t low : array) fn(low);
+      }
+    }
+  };
+
+  std::vector<Container> containers_;  // по возрастанию key
+
+ public:
+  bool add(uint32_t value) {
+    return findOrCreate(high(value)).add(low(value));
+  }
+
+  bool remove(uint32_t value) {
+    auto it = find(high(value));
+    if (it == containers_.end() || !it->remove(low(value))) return false;
+    if (it->cardinality == 0) containers_.erase(it);
+    return true;
+  }
+
+  bool contains(uint32_t value) const {
+    auto it = find(high(value));
+    return it != containers_.end() && it->contains(low(value));
+  }
+
+  uint64_t cardinality() const {
+    uint64_t total = 0;
+    for (const auto& container : containers_) total += container.cardinality;
+    return total;
+  }
+
+  bool empty() const { return containers_.empty(); }
+
+  void clear() { containers_.clear(); }
+
+  template <typename Fn>
+  void forEach(Fn fn) const {
+    for (const auto& container : containers_) {
+      uint32_t base = static_cast<uint32_t>(container.key) << 16;
+      container.forEach([&](uint16_t low) { fn(base | low); });
+    }
+  }
+
+  std::vector<uint32_t> toVector() const {
+    std::vector<uint32_t> result;
+    result.reserve(cardinality());
+    forEach([&result](uint32_t value) { result.push_back(value); });
+    return result;
+  }
+
+  // ---- Ядра операций над множествами ----
+
+  static RoaringBitmap intersect(const RoaringBitmap& a,
+                                 const RoaringBitmap& b) {
+    RoaringBitmap result;
+    auto i = a.containers_.begin();
+    auto j = b.containers_.begin();
+    while (i != a.containers_.end() && j != b.containers_.end()) {
+      if (i->key < j->key) {
+        ++i;
+      } else if (j->key < i->key) {
+        ++j;
+      } else {
+        Container c = intersect(*i, *j);
+        if (c.cardinality > 0) result.containers_.push_back(std::move(c));
+        ++i;
+        ++j;
+      }
+    }
+    return result;
+  }
+
+  static RoaringBitmap unite(const RoaringBitmap& a, const RoaringBitmap& b) {
+    RoaringBitmap result;
+    auto i = a.containers_.begin();
+    auto j = b.containers_.begin();
+    while (i != a.containers_.end() || j != b.containers_.end()) {
+      if (j == b.containers_.end() ||
+          (i != a.containers_.end() && i->key < j->key)) {
+        result.containers_.push_back(*i++);
+      } else if (i == a.containers_.end() || j->key < i->key) {
+        result.containers_.push_back(*j++);
+      } else {
+        result.containers_.push_back(unite(*i++, *j++));
+      }
+    }
+    return result;
+  }
+
+  // a \ b
+  static RoaringBitmap difference(const RoaringBitmap& a,
+                                  const RoaringBitmap& b) {
+    RoaringBitmap result;
+    auto j = b.containers_.begin();
+    for (const auto& container : a.containers_) {
+      while (j != b.containers_.end() && j->key < container.key) ++j;
+      if (j == b.containers_.end() || j->key != container.key) {
+        result.containers_.push_back(container);
+        continue;
+      }
+      Container c = difference(container, *j);
+      if (c.cardinality > 0) result.containers_.push_back(std::move(c));
+    }
+    return result;
+  }
+
+  RoaringBitmap& operator&=(const RoaringBitmap& other) {
+    return *this = intersect(*this, other);
+  }
+
+  RoaringBitmap& operator|=(const RoaringBitmap& other) {
+    return *this = unite(*this, other);
+  }
+
+  RoaringBitmap& operator-=(const RoaringBitmap& other) {
+    return *this = difference(*this, other);
+  }
+
+  bool operator==(const RoaringBitmap& other) const {
+    return toVector() == other.toVector();
+  }
+
+ private:
+  static uint16_t high(uint32_t value) {
+    return static_cast<uint16_t>(value >> 16);
+  }
+  static uint16_t low(uint32_t value) {
+    return static_cast<uint16_t>(value & 0xFFFF);
+  }
+
+  static uint32_t popcount(uint64_t word) {
+    return static_cast<uint32_t>(__builtin_popcountll(word));
+  }
+
+  static uint32_t countTrailingZeros(uint64_t word) {
+    return static_cast<uint32_t>(__builtin_ctzll(word));
+  }
+
+  std::vector<Container>::const_iterator find(uint16_t key) const {
+    auto it = std::lower_bound(
+        containers_.begin(), containers_.end(), key,
+        [](const Container& c, uint16_t k) { return c.key < k; });
+    return it != containers_.end() && it->key == key ? it : containers_.end();
+  }
+
+  std::vector<Container>::iterator find(uint16_t key) {
+    auto it = std::as_const(*this).find(key);
+    return containers_.begin() + (it - containers_.cbegin());
+  }
+
+  Container& findOrCreate(uint16_t key) {
+    auto it = std::lower_bound(
+        containers_.begin(), containers_.end(), key,
+        [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) {
+      it = containers_.insert(it, Container{});
+      it->key = key;
+    }
+    return *it;
+  }
+
+  static Container intersect(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+      result.bits.resize(BITMAP_WORDS);
+      for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+        result.bits[w] = a.bits[w] & b.bits[w];
+      }
+      result.normalizeBitmap();
+    } else if (a.isBitmap() || b.isBitmap()) {
+      const Container& sparse = a.isBitmap() ? b : a;
+      const Container& dense = a.isBitmap() ? a : b;
+      for (uint16_t low : sparse.array) {
+        if (dense.contains(low)) result.array.push_back(low);
+      }
+      result.cardinality = static_cast<uint32_t>(result.array.size());
+    } else {
+      std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(),
+                            b.array.end(), std::back_inserter(result.array));
+      result.cardinality = static_cast<uint32_t>(result.array.size());
+    }
+    return result;
+  }
+
+  static Container unite(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (!a.isBitmap() && !b.isBitmap() &&
+        a.array.size() + b.array.size() <= ARRAY_LIMIT) {
+      std::set_union(a.array.begin(), a.array.end(), b.array.begin(),
+                     b.array.end(), std::back_inserter(result.array));
+      result.cardinality = static_cast<uint32_t>(result.array.size());
+      return result;
+    }
+
+    result.bits.assign(BITMAP_WORDS, 0);
+    for (const Container* source : {&a, &b}) {
+      if (source->isBitmap()) {
+        for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+          result.bits[w] |= source->bits[w];
+        }
+      } else {
+        for (uint16_t low : source->array) {
+          result.bits[low >> 6] |= uint64_t{1} << (low & 63);
+        }
+      }
+    }
+    result.normalizeBitmap();
+    return result;
+  }
+
+  static Container difference(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap()) {
+      result.bits = a.bits;
+      if (b.isBitmap()) {
+        for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+          result.bits[w] &= ~b.bits[w];
+        }
+      } else {
+        for (uint16_t low : b.array) {
+          result.bits[low >> 6] &= ~(uint64_t{1} << (low & 63));
+        }
+      }
+      result.normalizeBitmap();
+    } else if (b.isBitmap()) {
+      for (uint16_t low : a.array) {
+        if (!b.contains(low)) result.array.push_back(low);
+      }
+      result.cardinality = static_cast<uint32_t>(result.array.size());
+    } else {
+      std::set_difference(a.array.begin(), a.array.end(), b.array.begin(),
+                          b.array.end(), std::back_inserter(result.array));
+      result.cardinality = static_cast<uint32_t>(result.array.size());
+    }
+    return result;
+  }
+};
+
+}  // namespace financial
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace financial {
+
+// Ограниченная очередь для одного производителя и одного потребителя.
+// Кольцо слотов без блокировок: производитель двигает только хвост,
+// потребитель — только голову, поэтому каждая сторона пишет в свою
+// строку кэша. Блокирующие push/pop ждут места или элемента: сначала
+// крутятся, затем уступают процессор, затем засыпают короткими паузами.
+//
+// close() закрывает очередь с любой стороны: push больше не принимает
+// элементы, pop отдаёт оставшиеся и затем возвращает false.
+template <typename T>
+class SpscQueue {
+ private:
+  size_t mask_;
+  std::unique_ptr<T[]> slots_;
+  alignas(64) std::atomic<size_t> head_{0};  // следующий для чтения
+  alignas(64) std::atomic<size_t> tail_{0};  // следующий для записи
+  alignas(64) std::atomic<bool> closed_{false};
+
+ public:
+  explicit SpscQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+    mask_ = size - 1;
+    slots_.reset(new T[size]);
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  size_t size() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+  // value перемещается в очередь только при успехе
+  bool tryPush(T& value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) return false;
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPop(T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    value = std::move(slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // false — очередь закрыта, элемент не принят
+  bool push(T value) {
+    Backoff backoff;
+    while (!closed_.load(std::memory_order_acquire)) {
+      if (tryPush(value)) return true;
+      backoff.pause();
+    }
+    return false;
+  }
+
+  // false — очередь закрыта и пуста
+  bool pop(T& value) {
+    Backoff backoff;
+    while (true) {
+      if (tryPop(value)) return true;
+      if (closed_.load(std::memory_order_acquire)) {
+        // Элемент мог появиться между проверкой и закрытием
+        return tryPop(value);
+      }
+      backoff.pause();
+    }
+  }
+
+  void close() { closed_.store(true, std::memory_order_release); }
+  bool isClosed() const { return closed_.load(std::memory_order_acquire); }
+
+ private:
+  class Backoff {
+   private:
+    static constexpr unsigned SPINS = 64;
+    static constexpr unsigned YIELDS = 64;
+    unsigned attempt_ = 0;
+
+   public:
+    void pause() {
+      if (attempt_ < SPINS) {
+        ++attempt_;
+      } else if (attempt_ < SPINS + YIELDS) {
+        ++attempt_;
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    }
+  };
+};
+
+}  // namespace financial
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+namespace financial {
+
+// Хеш-множество для одновременной вставки из нескольких потоков.
+// Ключи распределяются по STRIPES независимым сегментам со своим
+// мьютексом, поэтому потоки блокируют друг друга, только попав
+// в один сегмент. Выбор сегмента — по старшим битам хеша, чтобы
+// не коррелировать с выбором корзины внутри unordered_set.
+template <typename Key, typename Hash = std::hash<Key>,
+          size_t STRIPES = 64>
+class StripedHashSet {
+ private:
+  struct alignas(64) Stripe {
+    std::mutex mutex;
+    std::unordered_set<Key, Hash> keys;
+  };
+
+  std::array<Stripe, STRIPES> stripes_;
+  Hash hash_;
+
+ public:
+  // false, если ключ уже был в множестве
+  bool insert(const Key& key) {
+    Stripe& stripe = stripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    return stripe.keys.insert(key).second;
+  }
+
+  bool contains(const Key& key) {
+    Stripe& stripe = stripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    return stripe.keys.count(key) > 0;
+  }
+
+  void reserve(size_t count) {
+    for (auto& stripe : stripes_) {
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      stripe.keys.reserve(count / STRIPES + 1);
+    }
+  }
+
+  size_t size() {
+    size_t total = 0;
+    for (auto& stripe : stripes_) {
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      total += stripe.keys.size();
+    }
+    return total;
+  }
+
+ private:
+  Stripe& stripeFor(const Key& key) {
+    size_t h = hash_(key);
+    return stripes_[(h >> (sizeof(size_t) * 8 - 16)) % STRIPES];
+  }
+};
+
+}  // namespace financial
@@ -0,0 +1,454 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/numa_topology.h"
+
+namespace financial {
+
+// Флаг отмены, общий для группы задач и всех, кто её наблюдает
+class CancellationToken {
+ private:
+  std::shared_ptr<std::atomic<bool>> cancelled_ =
+      std::make_shared<std::atomic<bool>>(false);
+
+ public:
+  void cancel() { cancelled_->store(true, std::memory_order_release); }
+  bool isCancelled() const {
+    return cancelled_->load(std::memory_order_acquire);
+  }
+};
+
+struct ThreadPoolMetrics {
+  size_t workers = 0;
+  size_t queued = 0;
+  uint64_t submitted = 0;
+  uint64_t completed = 0;
+  uint64_t stolen = 0;
+  uint64_t cancelled = 0;
+  uint64_t failed = 0;
+  double busySeconds = 0.0;
+};
+
+// Пул потоков с перехватом работы (work stealing). У каждого рабочего
+// своя очередь: свои задачи он берёт с конца (последняя поставленная —
+// ещё в кэше), чужие крадёт с начала. Задачи, поставленные извне пула,
+// раскладываются по очередям по кругу.
+//
+// Рабочие распределяются по узлам NUMA пропорционально числу их
+// процессоров и привязываются к узлу. Задачу можно поставить на узел
+// (postToNode): её возьмёт рабочий этого узла, а красть рабочие
+// сначала пытаются у соседей по узлу.
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+ private:
+  struct alignas(64) Worker {
+    size_t node = 0;
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::thread thread;
+  };
+
+  struct CurrentWorker {
+    const ThreadPool* pool = nullptr;
+    size_t index = 0;
+  };
+
+  NumaTopology topology_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::vector<size_t>> workersByNode_;
+
+  std::mutex sleepMutex_;
+  std::condition_variable wake_;
+  std::atomic<size_t> queued_{0};
+  bool stopping_ = false;
+  std::atomic<size_t> nextWorker_{0};
+
+  std::atomic<uint64_t> submitted_{0};
+  std::atomic<uint64_t> completed_{0};
+  std::atomic<uint64_t> stolen_{0};
+  std::atomic<uint64_t> cancelled_{0};
+  std::atomic<uint64_t> failed_{0};
+  std::atomic<uint64_t> busyNanoseconds_{0};
+
+ public:
+  explicit ThreadPool(size_t threads = 0)
+      : ThreadPool(NumaTopology::singleNode(), threads) {}
+
+  // threads == 0 — по числу процессоров топологии
+  ThreadPool(const NumaTopology& topology, size_t threads)
+      : topology_(topology) {
+    std::vector<size_t> perNode = distribute(threads);
+    workersByNode_.resize(topology_.nodeCount());
+    for (size_t node = 0; node < perNode.size(); ++node) {
+      for (size_t i = 0; i < perNode[node]; ++i) {
+        workersByNode_[node].push_back(workers_.size());
+        workers_.push_back(std::make_unique<Worker>());
+        workers_.back()->node = node;
+      }
+    }
+    for (size_t index = 0; index < workers_.size(); ++index) {
+      workers_[index]->thread = std::thread([this, index]() { run(index); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Уже поставленные задачи выполняются до конца
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) worker->thread.join();
+  }
+
+  size_t workerCount() const { return workers_.size(); }
+  size_t nodeCount() const { return topology_.nodeCount(); }
+  // Рабочие узла; на узле может не оказаться ни одного, если потоков
+  // меньше, чем узлов
+  size_t nodeWorkerCount(size_t node) const {
+    return workersByNode_[node % workersByNode_.size()].size();
+  }
+
+  // Задача без результата; исключение из неё учитывается в failed
+  void post(Task task) { push(std::move(task), nullptr); }
+
+  void postToNode(size_t node, Task task) {
+    const auto& candidates = workersByNode_[node % workersByNode_.size()];
+    push(std::move(task), candidates.empty() ? nullptr : &candidates);
+  }
+
+  template <typename Fn>
+  auto submit(Fn fn) -> std::future<std::invoke_result_t<Fn>> {
+    using Result = std::invoke_result_t<Fn>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+    std::future<Result> future = task->get_future();
+    post([task]() { (*task)(); });
+    return future;
+  }
+
+  // Выполнить одну ожидающую задачу в вызывающем потоке. Так ждущий
+  // результата поток помогает пулу, а не блокирует рабочего
+  bool runPendingTask() {
+    Task task;
+    size_t self = currentIndex();
+    if (!take(self, task)) return false;
+    execute(task);
+    return true;
+  }
+
+  // Вызывающий поток — рабочий этого пула
+  bool isWorkerThread() const { return current().pool == this; }
+
+  void recordCancelled() {
+    cancelled_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ThreadPoolMetrics metrics() const {
+    ThreadPoolMetrics result;
+    result.workers = workers_.size();
+    result.queued = queued_.load(std::memory_order_relaxed);
+    result.submitted = submitted_.load(std::memory_order_relaxed);
+    result.completed = completed_.load(std::memory_order_relaxed);
+    result.stolen = stolen_.load(std::memory_order_relaxed);
+    result.cancelled = cancelled_.load(std::memory_order_relaxed);
+    result.failed = failed_.load(std::memory_order_relaxed);
+    result.busySeconds =
+        busyNanoseconds_.load(std::memory_order_relaxed) / 1e9;
+    return result;
+  }
+
+ private:
+  static CurrentWorker& current() {
+    static thread_local CurrentWorker worker;
+    return worker;
+  }
+
+  // Индекс рабочего вызывающего потока или workers_.size() для чужого
+  size_t currentIndex() const {
+    return isWorkerThread() ? current().index : workers_.size();
+  }
+
+  std::vector<size_t> distribute(size_t threads) const {
+    size_t nodes = topology_.nodeCount();
+    size_t cpus = 0;
+    for (const auto& node : topology_.nodes()) cpus += node.cpus.size();
+    if (threads == 0) {
+      threads = cpus > 0 ? cpus
+                         : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<size_t> perNode(nodes, 0);
+    if (cpus == 0) {
+      for (size_t i = 0; i < threads; ++i) perNode[i % nodes]++;
+      return perNode;
+    }
+    size_t assigned = 0;
+    for (size_t node = 0; node < nodes; ++node) {
+      perNode[node] = threads * topology_.nodes()[node].cpus.size() / cpus;
+      assigned += perNode[node];
+    }
+    for (size_t node = 0; assigned < threads; node = (node + 1) % nodes) {
+      perNode[node]++;
+      assigned++;
+    }
+    return perNode;
+  }
+
+  void push(Task task, const std::vector<size_t>* candidates) {
+    size_t self = currentIndex();
+    size_t target;
+    if (self < workers_.size() &&
+        (!candidates || workers_[self]->node ==
+                            workers_[candidates->front()]->node)) {
+      target = self;
+    } else {
+      size_t ticket = nextWorker_.fetch_add(1, std::memory_order_relaxed);
+      target = candidates ? (*candidates)[ticket % candidates->size()]
+                          : ticket % workers_.size();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+      workers_[target]->tasks.push_back(std::move(task));
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+      // Пустая секция: рабочий между проверкой условия и сном
+      // не пропустит уведомление
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wake_.notify_one();
+  }
+
+  // Своя очередь с конца, затем чужие с начала: сначала свой узел
+  bool take(size_t self, Task& task) {
+    if (queued_.load(std::memory_order_acquire) == 0) return false;
+
+    if (self < workers_.size()) {
+      Worker& own = *workers_[self];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+
+    size_t start = self < workers_.size() ? self + 1 : 0;
+    size_t ownNode = self < workers_.size() ? workers_[self]->node : 0;
+    for (int pass = 0; pass < 2; ++pass) {
+      for (size_t i = 0; i < workers_.size(); ++i) {
+        size_t victim = (start + i) % workers_.size();
+        if (victim == self) continue;
+        bool sameNode = workers_[victim]->node == ownNode;
+        if ((pass == 0) != sameNode) continue;
+
+        Worker& other = *workers_[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (other.tasks.empty()) continue;
+        task = std::move(other.tasks.front());
+        other.tasks.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        if (self < workers_.size()) {
+          stolen_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void execute(Task& task) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+      task();
+    } catch (...) {
+      failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    busyNanoseconds_.fetch_add(
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count()),
+        std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void run(size_t index) {
+    current() = CurrentWorker{this, index};
+    if (topology_.isNuma()) topology_.pinCurrentThread(workers_[index]->node);
+
+    Task task;
+    while (true) {
+      if (take(index, task)) {
+        execute(task);
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleepMutex_);
+      wake_.wait(lock, [this]() {
+        return stopping_ || queued_.load(std::memory_order_acquire) > 0;
+      });
+      if (stopping_ && queued_.load(std::memory_order_acquire) == 0) return;
+    }
+  }
+};
+
+// Группа задач с общим ожиданием и отменой. wait() не просто спит:
+// ждущий поток выполняет задачи пула, поэтому группы можно вкладывать
+// друг в друга, в том числе внутри рабочих потоков. Первое исключение
+// отменяет группу и пробрасывается из wait(). Без пула (nullptr) задачи
+// выполняются сразу в вызывающем потоке.
+class TaskGroup {
+ private:
+  ThreadPool* pool_;
+  CancellationToken token_;
+  std::atomic<size_t> pending_{0};
+  std::mutex mutex_;
+  std::condition_variable done_;
+  std::exception_ptr error_;
+
+ public:
+  explicit TaskGroup(ThreadPool* pool, CancellationToken token = {})
+      : pool_(pool), token_(std::move(token)) {}
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  ~TaskGroup() {
+    try {
+      wait();
+    } catch (...) {
+      // Ошибку должен был забрать явный wait()
+    }
+  }
+
+  void run(std::function<void()> fn) { schedule(std::move(fn), nullptr); }
+
+  void runOnNode(size_t node, std::function<void()> fn) {
+    schedule(std::move(fn), &node);
+  }
+
+  void wait() {
+    using namespace std::chrono_literals;
+    while (pending_.load(std::memory_order_acquire) > 0) {
+      if (pool_ && pool_->runPendingTask()) continue;
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_.wait_for(lock, 1ms, [this]() {
+        return pending_.load(std::memory_order_acquire) == 0;
+      });
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_) {
+      auto error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  void cancel() { token_.cancel(); }
+  bool isCancelled() const { return token_.isCancelled(); }
+  const CancellationToken& token() const { return token_; }
+
+ private:
+  void schedule(std::function<void()> fn, const size_t* node) {
+    if (!pool_) {
+      invoke(fn);
+      return;
+    }
+    pending_.fetch_add(1, std::memory_order_acq_rel);
+    auto task = [this, fn = std::move(fn)]() {
+      invoke(fn);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        done_.notify_all();
+      }
+    };
+    if (node) {
+      pool_->postToNode(*node, std::move(task));
+    } else {
+      pool_->post(std::move(task));
+    }
+  }
+
+  void invoke(const std::function<void()>& fn) {
+    if (token_.isCancelled()) {
+      if (pool_) pool_->recordCancelled();
+      return;
+    }
+    try {
+      fn();
+    } catch (...) {
+      token_.cancel();
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) error_ = std::current_exception();
+    }
+  }
+};
+
+// fn(from, to) для диапазонов [begin, end) по grain элементов. Отмена
+// проверяется перед каждым диапазоном; без пула — последовательно
+template <typename Fn>
+void parallelFor(ThreadPool* pool, size_t begin, size_t end, size_t grain,
+                 Fn fn, CancellationToken token = {}) {
+  if (begin >= end) return;
+  grain = std::max<size_t>(1, grain);
+
+  TaskGroup group(pool, std::move(token));
+  for (size_t from = begin; from < end; from += grain) {
+    size_t to = std::min(end, from + grain);
+    group.run([&fn, from, to]() { fn(from, to); });
+  }
+  group.wait();
+}
+
+// Свёртка по диапазонам: map(from, to) -> T для каждого диапазона,
+// затем combine слева направо в порядке диапазонов, так что результат
+// не зависит от числа потоков
+template <typename T, typename Map, typename Combine>
+T parallelReduce(ThreadPool* pool, size_t begin, size_t end, size_t grain,
+                 T identity, Map map, Combine combine,
+                 CancellationToken token = {}) {
+  if (begin >= end) return identity;
+  grain = std::max<size_t>(1, grain);
+
+  size_t chunks = (end - begin + grain - 1) / grain;
+  std::vector<T> partial(chunks, identity);
+  parallelFor(
+      pool, 0, chunks, 1,
+      [&](size_t first, size_t last) {
+        for (size_t chunk = first; chunk < last; ++chunk) {
+          size_t from = begin + chunk * grain;
+          partial[chunk] = map(from, std::min(end, from + grain));
+        }
+      },
+      std::move(token));
+
+  T result = std::move(identity);
+  for (auto& value : partial) result = combine(std::move(result), std::move(value));
+  return result;
+}
+
+}  // namespace financial
@@ -28,13 +28,6 @@ class Entity {
   bool operator!=(const Entity& other) const { return !(*this == other); }
 };
 
-// Base Value Object
-class ValueObject {
- public:
-  virtual ~ValueObject() = default;
-  virtual bool equals(const ValueObject& other) const = 0;
-};
-
 template <typename T, typename E>
 class Result {
  private:
@@ -5,16 +5,20 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <optional>
 #include <sstream>
+#include <string_view>
+#include <vector>
 #include "types.h"
 
 namespace financial {
 
 class IdGenerator {
 private:
-    static std::random_device rd_;
-    static std::mt19937 gen_;
-    static std::uniform_int_distribution<> dis_;
+    // Генератор у каждого потока свой: идентификаторы создаются
+    // параллельно проводками и переводами
+    static thread_local std::mt19937 gen_;
+    static thread_local std::uniform_int_distribution<> dis_;
 
 public:
     static std::string generate(const std::string& prefix = "") {
@@ -36,12 +40,38 @@ public:
 
         return ss.str();
     }
+
+    // Блок из count идентификаторов: общая часть (префикс, время, случайный
+    // хвост) формируется один раз, к ней добавляется порядковый номер
+    static std::vector<std::string> generateBlock(const std::string& prefix,
+                                                  size_t count) {
+        std::string base = generate(prefix) + "-";
+        std::vector<std::string> ids;
+        ids.reserve(count);
+
+        static constexpr char HEX[] = "0123456789abcdef";
+        char suffix[2 * sizeof(size_t)];
+        for (size_t i = 0; i < count; ++i) {
+            size_t length = 0;
+            size_t value = i;
+            do {
+                suffix[length++] = HEX[value & 0xF];
+                value >>= 4;
+            } while (value != 0);
+
+            std::string id;
+            id.reserve(base.size() + length);
+            id.append(base);
+            while (length > 0) id.push_back(suffix[--length]);
+            ids.push_back(std::move(id));
+        }
+        return ids;
+    }
 };
 
 // Static member definitions
-inline std::random_device IdGenerator::rd_;
-inline std::mt19937 IdGenerator::gen_(rd_());
-inline std::uniform_int_distribution<> IdGenerator::dis_(0, 15);
+inline thread_local std::mt19937 IdGenerator::gen_(std::random_device{}());
+inline thread_local std::uniform_int_distribution<> IdGenerator::dis_(0, 15);
 
 class DateTimeUtils {
 public:
@@ -63,6 +93,54 @@ public:
         return std::chrono::system_clock::from_time_t(std::mktime(&tm));
     }
 
+    // Строгий разбор "YYYY-MM-DD HH:MM:SS" без потоков и исключений:
+    // годится для проверки больших файлов из нескольких потоков
+    static std::optional<DateTime> tryParse(std::string_view str) {
+        std::tm tm = {};
+        if (!tryParseFields(str, tm)) return std::nullopt;
+        return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+    }
+
+    // Только разбор и проверка полей, без перевода в time_point
+    // (mktime обращается к часовому поясу и заметно дороже самого разбора)
+    static bool tryParseFields(std::string_view str, std::tm& tm) {
+        static constexpr char PATTERN[] = "dddd-dd-dd dd:dd:dd";
+        if (str.size() != sizeof(PATTERN) - 1) return false;
+        for (size_t i = 0; i < str.size(); ++i) {
+            bool digit = str[i] >= '0' && str[i] <= '9';
+            if (PATTERN[i] == 'd' ? !digit : str[i] != PATTERN[i]) {
+                return false;
+            }
+        }
+
+        auto number = [str](size_t pos, size_t length) {
+            int value = 0;
+            for (size_t i = pos; i < pos + length; ++i) {
+                value = value * 10 + (str[i] - '0');
+            }
+            return value;
+        };
+
+        tm = {};
+        tm.tm_year = number(0, 4) - 1900;
+        tm.tm_mon = number(5, 2) - 1;
+        tm.tm_mday = number(8, 2);
+        tm.tm_hour = number(11, 2);
+        tm.tm_min = number(14, 2);
+        tm.tm_sec = number(17, 2);
+
+        static constexpr int DAYS_IN_MONTH[] = {31, 29, 31, 30, 31, 30,
+                                                31, 31, 30, 31, 30, 31};
+        if (tm.tm_mon < 0 || tm.tm_mon > 11 || tm.tm_mday < 1 ||
+            tm.tm_mday > DAYS_IN_MONTH[tm.tm_mon] || tm.tm_hour > 23 ||
+            tm.tm_min > 59 || tm.tm_sec > 60) {
+            return false;
+        }
+        int year = tm.tm_year + 1900;
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        return tm.tm_mon != 1 || tm.tm_mday != 29 || leap;
+    }
+
     static DateTime startOfDay(const DateTime& dt) {
         auto time_t = std::chrono::system_clock::to_time_t(dt);
         std::tm* tm = std::localtime(&time_t);
@@ -3,14 +3,45 @@
 #include <algorithm>
 #include <regex>
 #include <string>
+#include <string_view>
 
+#include "error_codes.h"
 #include "exceptions.h"
 
 namespace financial {
 
-// Класс для валидации данных
+// Класс для валидации данных.
+// check* возвращают код ошибки и не бросают исключений,
+// validate* бросают ValidationException с описанием поля.
 class Validator {
  public:
+  static ErrorCode checkNotEmpty(const std::string& value) {
+    return value.empty() ? ErrorCode::EMPTY_VALUE : ErrorCode::NONE;
+  }
+
+  static ErrorCode checkPositive(double value) {
+    return value <= 0 ? ErrorCode::NOT_POSITIVE : ErrorCode::NONE;
+  }
+
+  static ErrorCode checkNonNegative(double value) {
+    return value < 0 ? ErrorCode::NEGATIVE_VALUE : ErrorCode::NONE;
+  }
+
+  static ErrorCode checkMaxLength(const std::string& value, size_t maxLength) {
+    return value.length() > maxLength ? ErrorCode::TOO_LONG : ErrorCode::NONE;
+  }
+
+  // Эквивалент ^[a-zA-Z0-9-]+$ без построения регулярного выражения
+  static ErrorCode checkId(std::string_view id) {
+    if (id.empty()) return ErrorCode::EMPTY_VALUE;
+    for (char c : id) {
+      bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                   (c >= '0' && c <= '9') || c == '-';
+      if (!valid) return ErrorCode::INVALID_ID;
+    }
+    return ErrorCode::NONE;
+  }
+
   static void validateNotEmpty(const std::string& value,
                                const std::string& fieldName) {
     if (value.empty()) {
@@ -42,8 +73,7 @@ class Validator {
   static void validateId(const std::string& id) {
     validateNotEmpty(id, "ID");
     // проверка что символы в id - цифры или латинские буквы
-    std::regex idPattern("^[a-zA-Z0-9-]+$");
-    if (!std::regex_match(id, idPattern)) {
+    if (checkId(id) != ErrorCode::NONE) {
       throw ValidationException("Invalid ID format");
     }
   }
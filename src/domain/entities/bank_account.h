@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <vector>
 
+#include "common/error_codes.h"
 #include "common/exceptions.h"
 #include "common/types.h"
 #include "common/utils.h"
@@ -20,7 +21,7 @@ class BankAccount : public Entity<BankAccount> {
   bool isActive_;
   DateTime createdAt_;
   DateTime updatedAt_;
-  std::string currency_;
+  CurrencyCode currency_;
 
  public:
   BankAccount(const Id& id, const std::string& name,
@@ -33,7 +34,7 @@ class BankAccount : public Entity<BankAccount> {
         isActive_(isActive),
         createdAt_(DateTimeUtils::now()),
         updatedAt_(DateTimeUtils::now()),
-        currency_(initialBalance.getCurrency()) {
+        currency_(initialBalance.getCurrencyCode()) {
     validate();
   }
 
@@ -46,7 +47,10 @@ class BankAccount : public Entity<BankAccount> {
   [[nodiscard]] bool getIsActive() const { return isActive_; }
   [[nodiscard]] const DateTime& getCreatedAt() const { return createdAt_; }
   [[nodiscard]] const DateTime& getUpdatedAt() const { return updatedAt_; }
-  [[nodiscard]] const std::string& getCurrency() const { return currency_; }
+  [[nodiscard]] std::string getCurrency() const {
+    return currency_.toString();
+  }
+  [[nodiscard]] CurrencyCode getCurrencyCode() const { return currency_; }
 
   // сеттеры
   void setName(const std::string& name) {
@@ -73,37 +77,66 @@ class BankAccount : public Entity<BankAccount> {
   }
 
   void deposit(const Money& amount) {
-    if (!isActive_) {
-      throw DomainException("Cannot deposit to inactive account");
+    auto status = tryDeposit(amount);
+    if (status.isFailure()) {
+      raisePostingError(status.getError(), amount, true);
     }
-    if (amount.getCurrency() != currency_) {
-      throw ValidationException("Currency mismatch");
+  }
+
+  void withdraw(const Money& amount) {
+    auto status = tryWithdraw(amount);
+    if (status.isFailure()) {
+      raisePostingError(status.getError(), amount, false);
     }
-    if (!amount.isPositive()) {
-      throw ValidationException("Deposit amount must be positive");
+  }
+
+  // Варианты без исключений: при отказе состояние счёта не меняется
+  Status tryDeposit(const Money& amount) {
+    if (!isActive_) return errorStatus(ErrorCode::INACTIVE_ACCOUNT);
+    if (amount.getCurrencyCode() != currency_) {
+      return errorStatus(ErrorCode::CURRENCY_MISMATCH);
     }
+    if (!amount.isPositive()) return errorStatus(ErrorCode::NOT_POSITIVE);
 
     balance_ = balance_.add(amount);
     updateTimestamp();
+    return okStatus();
   }
 
-  void withdraw(const Money& amount) {
-    if (!isActive_) {
-      throw DomainException("Cannot withdraw from inactive account");
-    }
-    if (amount.getCurrency() != currency_) {
-      throw ValidationException("Currency mismatch");
-    }
-    if (!amount.isPositive()) {
-      throw ValidationException("Withdrawal amount must be positive");
-    }
-    if (balance_ < amount) {
-      throw InsufficientFundsException(amount.getAmount(),
-                                       balance_.getAmount());
+  Status tryWithdraw(const Money& amount) {
+    if (!isActive_) return errorStatus(ErrorCode::INACTIVE_ACCOUNT);
+    if (amount.getCurrencyCode() != currency_) {
+      return errorStatus(ErrorCode::CURRENCY_MISMATCH);
     }
+    if (!amount.isPositive()) return errorStatus(ErrorCode::NOT_POSITIVE);
+    if (balance_ < amount) return errorStatus(ErrorCode::INSUFFICIENT_FUNDS);
 
     balance_ = balance_.subtract(amount);
     updateTimestamp();
+    return okStatus();
+  }
+
+  // Бросить исключение, соответствующее коду отказа tryDeposit/tryWithdraw
+  [[noreturn]] void raisePostingError(ErrorCode code, const Money& amount,
+                                      bool isDeposit) const {
+    switch (code) {
+      case ErrorCode::INACTIVE_ACCOUNT:
+        throw DomainException(isDeposit
+                                  ? "Cannot deposit to inactive account"
+                                  : "Cannot withdraw from inactive account");
+      case ErrorCode::CURRENCY_MISMATCH:
+        throw ValidationException("Currency mismatch");
+      case ErrorCode::NOT_POSITIVE:
+        throw ValidationException(isDeposit
+                                      ? "Deposit amount must be positive"
+                                      : "Withdrawal amount must be positive");
+      case ErrorCode::INSUFFICIENT_FUNDS:
+        throw InsufficientFundsException(amount.getAmount(),
+                                         balance_.getAmount());
+      default:
+        throw DomainException(std::string("Posting failed: ") +
+                              errorCodeToString(code));
+    }
   }
 
   void transfer(BankAccount& targetAccount, const Money& amount) {
@@ -125,16 +158,16 @@ class BankAccount : public Entity<BankAccount> {
   }
 
   [[nodiscard]] bool canWithdraw(const Money& amount) const {
-    return isActive_ && balance_ >= amount && amount.getCurrency() == currency_;
+    return isActive_ && balance_ >= amount &&
+           amount.getCurrencyCode() == currency_;
   }
 
   // Пересчёт баланса
   void recalculateBalance(const Money& newBalance) {
-    if (newBalance.getCurrency() != currency_) {
+    if (newBalance.getCurrencyCode() != currency_) {
       throw ValidationException("Currency mismatch during recalculation");
     }
 
-    auto oldBalance = balance_;
     balance_ = newBalance;
     updateTimestamp();
   }
@@ -15,14 +15,17 @@ private:
     std::string description_;
     std::string color_; // для UI
     std::string icon_;
+    Id parentId_; // пустой у корневых категорий
     
 public:
     Category(const Id& id, CategoryType type, const std::string& name,
              const std::string& description = "", 
              const std::string& color = "#000000",
-             const std::string& icon = "default")
+             const std::string& icon = "default",
+             const Id& parentId = "")
         : Entity(id), type_(type), name_(name), 
-          description_(description), color_(color), icon_(icon) {
+          description_(description), color_(color), icon_(icon),
+          parentId_(parentId) {
         validate();
     }
     
@@ -32,6 +35,8 @@ public:
     const std::string& getDescription() const { return description_; }
     const std::string& getColor() const { return color_; }
     const std::string& getIcon() const { return icon_; }
+    const Id& getParentId() const { return parentId_; }
+    bool isRoot() const { return parentId_.empty(); }
     
     // сеттеры
     void setName(const std::string& name) {
@@ -54,6 +59,13 @@ public:
         icon_ = icon;
     }
     
+    // Пустой parentId делает категорию корневой.
+    // Циклы через несколько уровней отсекает CategoryTree.
+    void setParentId(const Id& parentId) {
+        validateParent(parentId);
+        parentId_ = parentId;
+    }
+    
     // Business logic methods
     bool isIncomeCategory() const {
         return type_ == CategoryType::INCOME;
@@ -91,6 +103,15 @@ private:
         Validator::validateNotEmpty(name_, "Category name");
         Validator::validateMaxLength(name_, 50, "Category name");
         Validator::validateMaxLength(description_, 200, "Category description");
+        validateParent(parentId_);
+    }
+    
+    void validateParent(const Id& parentId) const {
+        if (parentId.empty()) return;
+        Validator::validateId(parentId);
+        if (parentId == id_) {
+            throw ValidationException("Category cannot be its own parent");
+        }
     }
 };
 
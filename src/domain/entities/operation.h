@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "common/types.h"
 #include "common/utils.h"
 #include "common/validation.h"
@@ -9,8 +14,15 @@
 
 namespace financial::domain {
 
+class EntityFactory;
+
 // Класс операции - представляет собой транзакцию между счетами
 class Operation : public Entity<Operation> {
+ public:
+  static constexpr size_t MAX_TAG_LENGTH = 50;
+  // Суффикс описания операций, порождённых повторяющейся
+  static constexpr std::string_view RECURRING_SUFFIX = " (Recurring)";
+
  private:
   OperationType type_;
   Id bankAccountId_;
@@ -22,6 +34,7 @@ class Operation : public Entity<Operation> {
   DateTime updatedAt_;
   bool isRecurring_;
   std::string recurringPattern_;  // e.g., "MONTHLY", "WEEKLY", "YEARLY"
+  std::vector<std::string> tags_;  // отсортированы, без повторов
 
  public:
   Operation(const Id& id, OperationType type, const Id& bankAccountId,
@@ -42,6 +55,27 @@ class Operation : public Entity<Operation> {
     validate();
   }
 
+  // Ключ доступа к конструктору без повторной валидации. Создать его может
+  // только фабрика, которая уже проверила поля всего пакета.
+  class PrevalidatedTag {
+    friend class EntityFactory;
+    PrevalidatedTag() {}
+  };
+
+  Operation(PrevalidatedTag, Id id, OperationType type, Id bankAccountId,
+            const Money& amount, const DateTime& date, Id categoryId,
+            std::string description, const DateTime& createdAt)
+      : Entity(std::move(id)),
+        type_(type),
+        bankAccountId_(std::move(bankAccountId)),
+        amount_(amount),
+        date_(date),
+        description_(std::move(description)),
+        categoryId_(std::move(categoryId)),
+        createdAt_(createdAt),
+        updatedAt_(createdAt),
+        isRecurring_(false) {}
+
   // Геттеры
   OperationType getType() const { return type_; }
   const Id& getBankAccountId() const { return bankAccountId_; }
@@ -53,6 +87,31 @@ class Operation : public Entity<Operation> {
   const DateTime& getUpdatedAt() const { return updatedAt_; }
   bool getIsRecurring() const { return isRecurring_; }
   const std::string& getRecurringPattern() const { return recurringPattern_; }
+  const std::vector<std::string>& getTags() const { return tags_; }
+
+  bool hasTag(const std::string& tag) const {
+    return std::binary_search(tags_.begin(), tags_.end(), tag);
+  }
+
+  // Теги меняют индекс репозитория, поэтому после изменения
+  // операцию нужно сохранить через update()
+  bool addTag(const std::string& tag) {
+    Validator::validateNotEmpty(tag, "Tag");
+    Validator::validateMaxLength(tag, MAX_TAG_LENGTH, "Tag");
+    auto it = std::lower_bound(tags_.begin(), tags_.end(), tag);
+    if (it != tags_.end() && *it == tag) return false;
+    tags_.insert(it, tag);
+    updateTimestamp();
+    return true;
+  }
+
+  bool removeTag(const std::string& tag) {
+    auto it = std::lower_bound(tags_.begin(), tags_.end(), tag);
+    if (it == tags_.end() || *it != tag) return false;
+    tags_.erase(it);
+    updateTimestamp();
+    return true;
+  }
 
   // Сеттеры с валидацией
   void setAmount(const Money& amount) {
@@ -102,11 +161,16 @@ class Operation : public Entity<Operation> {
     return amount_;
   }
 
+  // Описание очередного повторения этой операции
+  std::string occurrenceDescription() const {
+    return description_ + std::string(RECURRING_SUFFIX);
+  }
+
   // Операция клонирования для повторяющихся транзакций
   Operation cloneForDate(const DateTime& newDate) const {
     return Operation(IdGenerator::generate("OP"), type_, bankAccountId_,
-                     amount_, newDate, categoryId_,
-                     description_ + " (Recurring)", false, "");
+                     amount_, newDate, categoryId_, occurrenceDescription(),
+                     false, "");
   }
 
   static Operation createIncome(const Id& bankAccountId, const Money& amount,
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
+#include "common/error_codes.h"
 #include "common/validation.h"
 #include "domain/entities/bank_account.h"
 #include "domain/entities/category.h"
@@ -9,6 +13,74 @@
 
 namespace financial::domain {
 
+// Пакет операций в колоночном виде: строка i — i-е элементы всех столбцов.
+// Столбец ids необязателен: пустой столбец или пустой id в строке
+// означает, что идентификатор выдаёт фабрика
+struct OperationColumns {
+  std::vector<Id> ids;
+  std::vector<OperationType> types;
+  std::vector<Id> bankAccountIds;
+  std::vector<Money> amounts;
+  std::vector<Id> categoryIds;
+  std::vector<std::string> descriptions;
+  std::vector<DateTime> dates;
+
+  size_t size() const { return types.size(); }
+
+  bool isConsistent() const {
+    size_t n = types.size();
+    return (ids.empty() || ids.size() == n) && bankAccountIds.size() == n &&
+           amounts.size() == n &&
+           categoryIds.size() == n && descriptions.size() == n &&
+           dates.size() == n;
+  }
+
+  void reserve(size_t count) {
+    types.reserve(count);
+    bankAccountIds.reserve(count);
+    amounts.reserve(count);
+    categoryIds.reserve(count);
+    descriptions.reserve(count);
+    dates.reserve(count);
+  }
+
+  void add(OperationType type, Id bankAccountId, const Money& amount,
+           Id categoryId, std::string description, const DateTime& date) {
+    if (!ids.empty()) ids.emplace_back();
+    types.push_back(type);
+    bankAccountIds.push_back(std::move(bankAccountId));
+    amounts.push_back(amount);
+    categoryIds.push_back(std::move(categoryId));
+    descriptions.push_back(std::move(description));
+    dates.push_back(date);
+  }
+
+  // Строка с заранее известным идентификатором (восстановление, импорт)
+  void add(Id id, OperationType type, Id bankAccountId, const Money& amount,
+           Id categoryId, std::string description, const DateTime& date) {
+    ids.resize(types.size());
+    ids.push_back(std::move(id));
+    types.push_back(type);
+    bankAccountIds.push_back(std::move(bankAccountId));
+    amounts.push_back(amount);
+    categoryIds.push_back(std::move(categoryId));
+    descriptions.push_back(std::move(description));
+    dates.push_back(date);
+  }
+};
+
+struct RejectedRow {
+  size_t row;
+  ErrorCode code;
+};
+
+// Результат пакетного создания: созданные операции в порядке строк
+// и отклонённые строки с кодом причины
+struct OperationBatchResult {
+  std::vector<std::shared_ptr<Operation>> created;
+  std::vector<RejectedRow> rejected;
+};
+
 // Интерфейс абстратной фабрики
 class IEntityFactory {
  public:
@@ -20,12 +92,32 @@ class IEntityFactory {
 
   virtual std::shared_ptr<Category> createCategory(
       CategoryType type, const std::string& name,
-      const std::string& description = "") = 0;
+      const std::string& description = "", const Id& parentId = "") = 0;
 
   virtual std::shared_ptr<Operation> createOperation(
       OperationType type, const Id& bankAccountId, const Money& amount,
       const Id& categoryId, const std::string& description = "",
       const DateTime& date = DateTimeUtils::now()) = 0;
+
+  // Вариант без исключений для пакетных путей: некорректные данные
+  // возвращаются кодом ошибки
+  virtual Result<std::shared_ptr<Operation>, ErrorCode> tryCreateOperation(
+      OperationType type, const Id& bankAccountId, const Money& amount,
+      const Id& categoryId, const std::string& description = "",
+      const DateTime& date = DateTimeUtils::now()) = 0;
+
+  // Пакетное создание операций для импорта и повторного проведения
+  virtual OperationBatchResult createOperations(OperationColumns columns) = 0;
+
+  // Воссоздание сущностей с известными идентификаторами: импорт
+  // и восстановление из резервной копии сохраняют ссылки между ними
+  virtual std::shared_ptr<BankAccount> restoreBankAccount(
+      const Id& id, const std::string& name, const Money& balance,
+      const std::string& accountNumber = "") = 0;
+
+  virtual std::shared_ptr<Category> restoreCategory(
+      const Id& id, CategoryType type, const std::string& name,
+      const std::string& description = "", const Id& parentId = "") = 0;
 };
 
 // Конкретная фабрика с валидацией
@@ -40,30 +132,41 @@ class EntityFactory : public IEntityFactory {
   std::shared_ptr<BankAccount> createBankAccount(
       const std::string& name, const Money& initialBalance = Money::zero(),
       const std::string& accountNumber = "") override {
+    return restoreBankAccount(IdGenerator::generate("ACC"), name,
+                              initialBalance, accountNumber);
+  }
+
+  std::shared_ptr<Category> createCategory(
+      CategoryType type, const std::string& name,
+      const std::string& description = "",
+      const Id& parentId = "") override {
+    return restoreCategory(IdGenerator::generate("CAT"), type, name,
+                           description, parentId);
+  }
+
+  std::shared_ptr<BankAccount> restoreBankAccount(
+      const Id& id, const std::string& name, const Money& balance,
+      const std::string& accountNumber = "") override {
+    Validator::validateId(id);
     Validator::validateNotEmpty(name, "Account name");
     Validator::validateMaxLength(name, MAX_ACCOUNT_NAME_LENGTH, "Account name");
-    Validator::validateNonNegative(initialBalance.getAmount(),
-                                   "Initial balance");
-
-    auto account = std::make_shared<BankAccount>(
-        IdGenerator::generate("ACC"), name, initialBalance, accountNumber);
+    Validator::validateNonNegative(balance.getAmount(), "Initial balance");
 
-    return account;
+    return std::make_shared<BankAccount>(id, name, balance, accountNumber);
   }
 
-  std::shared_ptr<Category> createCategory(
-      CategoryType type, const std::string& name,
-      const std::string& description = "") override {
+  std::shared_ptr<Category> restoreCategory(
+      const Id& id, CategoryType type, const std::string& name,
+      const std::string& description = "", const Id& parentId = "") override {
+    Validator::validateId(id);
     Validator::validateNotEmpty(name, "Category name");
     Validator::validateMaxLength(name, MAX_CATEGORY_NAME_LENGTH,
                                  "Category name");
     Validator::validateMaxLength(description, MAX_DESCRIPTION_LENGTH,
                                  "Category description");
 
-    auto category = std::make_shared<Category>(IdGenerator::generate("CAT"),
-                                               type, name, description);
-
-    return category;
+    return std::make_shared<Category>(id, type, name, description, "#000000",
+                                      "default", parentId);
   }
 
   std::shared_ptr<Operation> createOperation(
@@ -83,6 +186,111 @@ class EntityFactory : public IEntityFactory {
     return operation;
   }
 
+  Result<std::shared_ptr<Operation>, ErrorCode> tryCreateOperation(
+      OperationType type, const Id& bankAccountId, const Money& amount,
+      const Id& categoryId, const std::string& description = "",
+      const DateTime& date = DateTimeUtils::now()) override {
+    using OperationResult = Result<std::shared_ptr<Operation>, ErrorCode>;
+
+    for (ErrorCode code :
+         {Validator::checkId(bankAccountId), Validator::checkId(categoryId),
+          Validator::checkPositive(amount.getAmount()),
+          Validator::checkMaxLength(description, MAX_DESCRIPTION_LENGTH)}) {
+      if (code != ErrorCode::NONE) return OperationResult::failure(code);
+    }
+
+    return OperationResult::success(std::make_shared<Operation>(
+        IdGenerator::generate("OP"), type, bankAccountId, amount, date,
+        categoryId, description));
+  }
+
+  // Пакетное создание: все строки проверяются сплошными проходами
+  // по столбцам, идентификаторы выделяются одним блоком, а операции
+  // размещаются в одном непрерывном массиве без повторной валидации
+  // в конструкторе. Возвращаемые указатели разделяют владение массивом,
+  // поэтому он освобождается вместе с последней операцией пакета.
+  OperationBatchResult createOperations(OperationColumns columns) override {
+    if (!columns.isConsistent()) {
+      throw ValidationException("Operation columns have different lengths");
+    }
+
+    size_t rows = columns.size();
+    std::vector<ErrorCode> codes(rows, ErrorCode::NONE);
+
+    // Идентификаторы в пакете повторяются, каждый уникальный
+    // проверяется один раз
+    std::unordered_map<std::string_view, ErrorCode> checkedIds;
+    auto checkId = [&checkedIds](const Id& id) {
+      auto [it, inserted] = checkedIds.try_emplace(id, ErrorCode::NONE);
+      if (inserted) it->second = Validator::checkId(id);
+      return it->second;
+    };
+
+    bool hasIds = !columns.ids.empty();
+    for (size_t i = 0; i < rows; ++i) {
+      if (hasIds && !columns.ids[i].empty()) {
+        codes[i] = Validator::checkId(columns.ids[i]);
+      }
+    }
+    for (size_t i = 0; i < rows; ++i) {
+      if (codes[i] == ErrorCode::NONE) {
+        codes[i] = checkId(columns.bankAccountIds[i]);
+      }
+    }
+    for (size_t i = 0; i < rows; ++i) {
+      if (codes[i] == ErrorCode::NONE) {
+        codes[i] = checkId(columns.categoryIds[i]);
+      }
+    }
+    for (size_t i = 0; i < rows; ++i) {
+      if (codes[i] == ErrorCode::NONE) {
+        codes[i] = Validator::checkPositive(columns.amounts[i].getAmount());
+      }
+    }
+    for (size_t i = 0; i < rows; ++i) {
+      if (codes[i] == ErrorCode::NONE) {
+        codes[i] = Validator::checkMaxLength(columns.descriptions[i],
+                                             MAX_DESCRIPTION_LENGTH);
+      }
+    }
+
+    OperationBatchResult result;
+    for (size_t i = 0; i < rows; ++i) {
+      if (codes[i] != ErrorCode::NONE) result.rejected.push_back({i, codes[i]});
+    }
+
+    size_t valid = rows - result.rejected.size();
+    size_t missing = valid;
+    if (hasIds) {
+      missing = 0;
+      for (size_t i = 0; i < rows; ++i) {
+        if (codes[i] == ErrorCode::NONE && columns.ids[i].empty()) missing++;
+      }
+    }
+    auto ids = IdGenerator::generateBlock("OP", missing);
+    auto block = std::make_shared<std::vector<Operation>>();
+    block->reserve(valid);
+    result.created.reserve(valid);
+
+    DateTime createdAt = DateTimeUtils::now();
+    for (size_t i = 0, next = 0; i < rows; ++i) {
+      if (codes[i] != ErrorCode::NONE) continue;
+      Id id = hasIds && !columns.ids[i].empty() ? std::move(columns.ids[i])
+                                                : std::move(ids[next++]);
+      block->emplace_back(Operation::PrevalidatedTag{}, std::move(id),
+                          columns.types[i],
+                          std::move(columns.bankAccountIds[i]),
+                          columns.amounts[i], columns.dates[i],
+                          std::move(columns.categoryIds[i]),
+                          std::move(columns.descriptions[i]), createdAt);
+    }
+    for (auto& operation : *block) {
+      result.created.emplace_back(block, &operation);
+    }
+
+    return result;
+  }
+
   // Convenience methods for common scenarios
   std::shared_ptr<BankAccount> createSavingsAccount(
       const std::string& name, const std::string& currency = "RUB") {
@@ -3,9 +3,11 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "common/types.h"
+#include "domain/value_objects/date_range.h"
 #include "domain/value_objects/types.h"
 
 namespace financial::domain {
@@ -14,19 +16,53 @@ class BankAccount;
 class Category;
 class Operation;
 
-// Общий интерфейс для репозиториев
+// Снимок репозитория: состав и состояние сущностей на момент
+// IRepository::snapshot(). Последующие записи его не меняют
+template <typename T>
+class IRepositorySnapshot {
+ public:
+  virtual ~IRepositorySnapshot() = default;
+
+  // nullptr, если сущности в снимке нет
+  virtual std::shared_ptr<const T> findById(const Id& id) const = 0;
+  virtual void forEach(
+      const std::function<void(const T&)>& visitor) const = 0;
+  virtual size_t size() const = 0;
+};
+
+template <typename T>
+using RepositorySnapshot = std::shared_ptr<const IRepositorySnapshot<T>>;
+
+// Общий интерфейс для репозиториев.
+// Сохранённая сущность не меняется: save и update кладут в хранилище
+// свою копию, findById отдаёт копию, которую можно менять и передать
+// в update. Сущности из списков (findAll и запросы наследников) —
+// сохранённые версии, их только читают
 template <typename T>
 class IRepository {
  public:
   virtual ~IRepository() = default;
 
   virtual void save(std::shared_ptr<T> entity) = 0;
+  // Сохранить пакет сущностей одной операцией
+  virtual void saveAll(const std::vector<std::shared_ptr<T>>& entities) = 0;
   virtual void update(std::shared_ptr<T> entity) = 0;
   virtual void remove(const Id& id) = 0;
   virtual std::optional<std::shared_ptr<T>> findById(const Id& id) = 0;
   virtual std::vector<std::shared_ptr<T>> findAll() = 0;
   virtual size_t count() = 0;
   virtual void clear() = 0;
+
+  virtual RepositorySnapshot<T> snapshot() = 0;
+
+  // Вернуть сущностям ids их версии из previous (отсутствующие в нём
+  // удаляются) одной записью — при условии, что ни одна из них не
+  // менялась после снимка expected. Иначе ничего не меняется и
+  // возвращается false; false возвращает и репозиторий, который не
+  // умеет восстанавливать версии
+  virtual bool restore(const RepositorySnapshot<T>& previous,
+                       const RepositorySnapshot<T>& expected,
+                       const std::vector<Id>& ids) = 0;
 };
 
 // Интерфейс репозиторев для банковских счетов
@@ -46,6 +82,22 @@ class ICategoryRepository : public virtual IRepository<Category> {
       const std::string& name) = 0;
 };
 
+// Булев запрос по тегам операций: есть все теги allOf, хотя бы один
+// из anyOf (если список не пуст) и ни одного из noneOf
+struct TagQuery {
+  std::vector<std::string> allOf;
+  std::vector<std::string> anyOf;
+  std::vector<std::string> noneOf;
+};
+
+// Фильтр выборки операций; пустой список или отсутствующий период
+// означает "без ограничения"
+struct OperationFilter {
+  std::optional<DateRange> period;
+  std::vector<Id> accountIds;
+  std::vector<Id> categoryIds;
+};
+
 // Интерфейс репозиторев для банковский операций
 class IOperationRepository : public virtual IRepository<Operation> {
  public:
@@ -61,6 +113,27 @@ class IOperationRepository : public virtual IRepository<Operation> {
   // Поиск по какому-то условию
   virtual std::vector<std::shared_ptr<Operation>> findWhere(
       std::function<bool(const Operation&)> predicate) = 0;
+
+  virtual std::vector<std::shared_ptr<Operation>> findByTags(
+      const TagQuery& query) = 0;
+
+  // Передать посетителю операции, подходящие под фильтр, не собирая
+  // полный список. Реализация выбирает индекс по самому узкому условию
+  virtual void scan(const OperationFilter& filter,
+                    const std::function<void(const Operation&)>& visitor) = 0;
+
+  // Хранилище разбито на части по хешу счёта. scanPartition — то же,
+  // что scan, но только по счетам части partition; обход всех частей
+  // даёт ровно результат scan. Обходы разных частей могут идти
+  // параллельно
+  virtual size_t partitionCount() = 0;
+  // Узел NUMA, на котором лежит индекс части (номер узла пула, который
+  // его строил); обход части выгоднее запускать на рабочем этого узла.
+  // На машине с одним узлом — 0
+  virtual size_t partitionNode(size_t partition) = 0;
+  virtual void scanPartition(
+      size_t partition, const OperationFilter& filter,
+      const std::function<void(const Operation&)>& visitor) = 0;
 };
 
 // паттерн Unit of Work для реализации операций
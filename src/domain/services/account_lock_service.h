@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include "common/types.h"
+
+namespace financial::domain {
+
+// Блокировки счетов, общие для всех изменений баланса.
+// Каждый счёт защищён одной из LOCK_STRIPES блокировок (по хешу id).
+// Проводка, перевод, отмена операции и пересчёт баланса читают счёт,
+// меняют и сохраняют его под блокировкой полосы, поэтому параллельные
+// изменения одного счёта не теряют друг друга. Пара счетов
+// захватывается в порядке номеров полос: встречные переводы не
+// взаимоблокируются. Блокировки не рекурсивны — под удерживаемой
+// полосой нельзя вызывать код, который берёт её снова.
+class AccountLockService {
+ public:
+  static constexpr size_t LOCK_STRIPES = 64;
+
+  using Guard = std::unique_lock<std::mutex>;
+
+ private:
+  std::array<std::mutex, LOCK_STRIPES> stripes_;
+
+ public:
+  Guard lock(const Id& accountId) {
+    return Guard(stripes_[stripeOf(accountId)]);
+  }
+
+  // Если оба счёта попали в одну полосу, она захватывается один раз
+  std::pair<Guard, Guard> lockPair(const Id& first, const Id& second) {
+    size_t a = stripeOf(first);
+    size_t b = stripeOf(second);
+    if (a > b) std::swap(a, b);
+
+    Guard lower(stripes_[a]);
+    Guard upper;
+    if (b != a) upper = Guard(stripes_[b]);
+    return {std::move(lower), std::move(upper)};
+  }
+
+ private:
+  static size_t stripeOf(const Id& accountId) {
+    return std::hash<Id>{}(accountId) % LOCK_STRIPES;
+  }
+};
+
+}  // namespace financial::domain
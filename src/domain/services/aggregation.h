@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "common/types.h"
+#include "domain/entities/operation.h"
+#include "domain/value_objects/date_range.h"
+#include "domain/value_objects/money.h"
+#include "domain/value_objects/types.h"
+
+namespace financial::domain::aggregation {
+
+// Конвейер агрегации операций из политик, выбираемых на этапе компиляции:
+//   Aggregate<KeyPolicy, Reducer, Filter>::run(operations, filter)
+// Фильтр отбирает операции, ключ определяет группу, редьюсер накапливает
+// состояние группы. Для каждой комбинации компилятор генерирует отдельный
+// цикл без виртуальных вызовов и ветвлений по типу отчёта.
+
+// ---- Фильтры ----
+
+struct AnyOperation {
+  bool operator()(const Operation&) const { return true; }
+};
+
+template <OperationType Type>
+struct FilterType {
+  bool operator()(const Operation& op) const { return op.getType() == Type; }
+};
+
+// Тип, известный только во время выполнения
+struct FilterOperationType {
+  OperationType type;
+
+  bool operator()(const Operation& op) const { return op.getType() == type; }
+};
+
+struct FilterPeriod {
+  DateRange period;
+
+  bool operator()(const Operation& op) const {
+    return op.isInDateRange(period);
+  }
+};
+
+struct FilterAccount {
+  Id accountId;
+
+  bool operator()(const Operation& op) const {
+    return op.getBankAccountId() == accountId;
+  }
+};
+
+// Конъюнкция фильтров
+template <typename First, typename Second>
+struct Both {
+  First first;
+  Second second;
+
+  bool operator()(const Operation& op) const {
+    return first(op) && second(op);
+  }
+};
+
+// ---- Ключи группировки ----
+
+struct ByCategory {
+  using Key = Id;
+  static const Id& key(const Operation& op) { return op.getCategoryId(); }
+};
+
+struct ByAccount {
+  using Key = Id;
+  static const Id& key(const Operation& op) { return op.getBankAccountId(); }
+};
+
+struct ByType {
+  using Key = OperationType;
+  static OperationType key(const Operation& op) { return op.getType(); }
+};
+
+// Без группировки: результат — одно состояние редьюсера
+struct NoKey {};
+
+// ---- Редьюсеры ----
+
+struct SumAmount {
+  using State = double;
+  static void add(State& state, const Operation& op) {
+    state += op.getAmount().getAmount();
+  }
+  static void merge(State& state, const State& other) { state += other; }
+};
+
+struct CountOperations {
+  using State = size_t;
+  static void add(State& state, const Operation&) { state++; }
+  static void merge(State& state, const State& other) { state += other; }
+};
+
+// Сумма хранится в валюте первой операции; операция или частичный
+// результат в другой валюте — ValidationException из Money::add
+struct SumAndCount {
+  struct State {
+    Money total = Money::zero();
+    size_t count = 0;
+  };
+  static void add(State& state, const Operation& op) {
+    state.total = state.count == 0 ? op.getAmount()
+                                   : state.total.add(op.getAmount());
+    state.count++;
+  }
+  static void merge(State& state, const State& other) {
+    if (other.count == 0) return;
+    state.total = state.count == 0 ? other.total : state.total.add(other.total);
+    state.count += other.count;
+  }
+};
+
+struct MinMaxAmount {
+  struct State {
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+  };
+  static void add(State& state, const Operation& op) {
+    double amount = op.getAmount().getAmount();
+    state.min = std::min(state.min, amount);
+    state.max = std::max(state.max, amount);
+  }
+  static void merge(State& state, const State& other) {
+    state.min = std::min(state.min, other.min);
+    state.max = std::max(state.max, other.max);
+  }
+};
+
+// Чистое изменение баланса: доходы со знаком плюс, расходы со знаком минус
+struct SignedSum {
+  using State = double;
+  static void add(State& state, const Operation& op) {
+    double amount = op.getAmount().getAmount();
+    state += op.isIncome() ? amount : -amount;
+  }
+  static void merge(State& state, const State& other) { state += other; }
+};
+
+// ---- Агрегатор ----
+
+template <typename KeyPolicy, typename Reducer, typename Filter = AnyOperation>
+class Aggregate {
+ public:
+  using State = typename Reducer::State;
+  static constexpr bool IS_GROUPED = !std::is_same_v<KeyPolicy, NoKey>;
+
+ private:
+  template <typename K>
+  struct Grouped {
+    using type = std::unordered_map<typename K::Key, State>;
+  };
+
+  struct Single {
+    using type = State;
+  };
+
+ public:
+  // unordered_map<Key, State> для группировки, State для NoKey
+  using Result =
+      typename std::conditional_t<IS_GROUPED, Grouped<KeyPolicy>, Single>::type;
+
+  template <typename Range>
+  static Result run(const Range& operations, const Filter& filter = Filter{}) {
+    Result result{};
+    for (const auto& op : operations) add(result, *op, filter);
+    return result;
+  }
+
+  // Одна операция — для обхода через посетителя (scan, scanPartition)
+  static void add(Result& result, const Operation& operation,
+                  const Filter& filter = Filter{}) {
+    if (!filter(operation)) return;
+
+    if constexpr (IS_GROUPED) {
+      Reducer::add(result[KeyPolicy::key(operation)], operation);
+    } else {
+      Reducer::add(result, operation);
+    }
+  }
+
+  // Слить частичный результат, посчитанный по другой части операций
+  static void merge(Result& result, const Result& other) {
+    if constexpr (IS_GROUPED) {
+      for (const auto& [key, state] : other) {
+        Reducer::merge(result[key], state);
+      }
+    } else {
+      Reducer::merge(result, other);
+    }
+  }
+};
+
+}  // namespace financial::domain::aggregation
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/types.h"
+#include "domain/entities/operation.h"
+
+namespace financial::domain {
+
+// Сигнал о подозрительной операции
+struct AnomalyAlert {
+  enum class Kind { AMOUNT_SPIKE, BURST };
+
+  Kind kind;
+  Id operationId;
+  Id accountId;
+  Id categoryId;
+  DateTime date;
+  double amount;
+  // Для AMOUNT_SPIKE — скользящее среднее категории, для BURST — оценка
+  // числа операций по счёту за последнее окно
+  double expected;
+  double score;
+};
+
+inline std::string anomalyKindToString(AnomalyAlert::Kind kind) {
+  switch (kind) {
+    case AnomalyAlert::Kind::AMOUNT_SPIKE: return "AMOUNT_SPIKE";
+    case AnomalyAlert::Kind::BURST: return "BURST";
+    default: return "UNKNOWN";
+  }
+}
+
+// Ограниченная очередь сигналов для подписчиков.
+// Поставщик только кладёт сигнал, подписчики забирают их сами, когда удобно;
+// при переполнении вытесняются самые старые сигналы.
+class AnomalyAlertQueue {
+ private:
+  mutable std::mutex mutex_;
+  std::deque<AnomalyAlert> alerts_;
+  size_t capacity_;
+  size_t dropped_ = 0;
+
+ public:
+  explicit AnomalyAlertQueue(size_t capacity = 1024) : capacity_(capacity) {}
+
+  void push(AnomalyAlert alert) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (alerts_.size() >= capacity_) {
+      alerts_.pop_front();
+      dropped_++;
+    }
+    alerts_.push_back(std::move(alert));
+  }
+
+  // Забрать все накопленные сигналы
+  std::vector<AnomalyAlert> drain() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<AnomalyAlert> result(std::make_move_iterator(alerts_.begin()),
+                                     std::make_move_iterator(alerts_.end()));
+    alerts_.clear();
+    return result;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return alerts_.size();
+  }
+
+  size_t droppedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+  }
+};
+
+// Потоковый детектор аномалий по проводимым операциям.
+// Для каждой пары (счёт, категория) хранится EWMA среднего и дисперсии суммы
+// расхода, для каждого счёта — экспоненциально затухающий счётчик операций.
+// Статистика лежит в компактных хеш-таблицах с открытой адресацией, поэтому
+// обработка одной операции стоит O(1) и не выделяет память в штатном режиме.
+// Таблицы разбиты на SHARDS частей по хешу ключа, у каждой своя
+// блокировка: проводки по разным счетам почти никогда не ждут друг друга.
+// Всплески считаются по времени поступления операций в детектор, а не по
+// их дате, поэтому импорт и проводки задним числом не выглядят всплеском.
+class AnomalyDetector {
+ public:
+  struct Config {
+    double alpha = 0.1;             // вес нового наблюдения в EWMA
+    double zScoreThreshold = 4.0;   // порог отклонения суммы в сигмах
+    uint32_t warmupObservations = 5;
+    double burstHalfLifeSeconds = 60.0;
+    double burstThreshold = 10.0;   // операций за ~полупериод
+  };
+
+  static constexpr size_t SHARDS = 16;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Slot {
+    uint64_t hash = 0;  // 0 — свободная ячейка
+    // Сам ключ: ряды с совпавшим хешем не сливаются
+    Id accountId;
+    Id categoryId;
+    uint32_t observations = 0;
+    bool burstReported = false;
+    double mean = 0;
+    double variance = 0;
+    double lastSeconds = 0;
+
+    bool matches(uint64_t h, const Id& account, const Id& category) const {
+      return hash == h && accountId == account && categoryId == category;
+    }
+  };
+
+  // Хеш-таблица с линейным пробированием; хеш ключа выбирает начальную
+  // ячейку, совпадение подтверждается сравнением самого ключа
+  class StatsTable {
+   private:
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+
+   public:
+    StatsTable() : slots_(64) {}
+
+    Slot& findOrInsert(uint64_t hash, const Id& accountId,
+                       const Id& categoryId) {
+      if ((size_ + 1) * 10 > slots_.size() * 7) grow();
+
+      size_t mask = slots_.size() - 1;
+      for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Slot& slot = slots_[i];
+        if (slot.matches(hash, accountId, categoryId)) return slot;
+        if (slot.hash == 0) {
+          slot.hash = hash;
+          slot.accountId = accountId;
+          slot.categoryId = categoryId;
+          size_++;
+          return slot;
+        }
+      }
+    }
+
+    size_t size() const { return size_; }
+
+   private:
+    void grow() {
+      std::vector<Slot> old(slots_.size() * 2);
+      old.swap(slots_);
+      size_t mask = slots_.size() - 1;
+      for (auto& slot : old) {
+        if (slot.hash == 0) continue;
+        size_t i = slot.hash & mask;
+        while (slots_[i].hash != 0) i = (i + 1) & mask;
+        slots_[i] = std::move(slot);
+      }
+    }
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    StatsTable amountStats;
+    StatsTable burstStats;
+  };
+
+  Config config_;
+  std::shared_ptr<AnomalyAlertQueue> queue_;
+  std::array<Shard, SHARDS> shards_;
+  Clock::time_point started_ = Clock::now();
+
+ public:
+  explicit AnomalyDetector(
+      std::shared_ptr<AnomalyAlertQueue> queue =
+          std::make_shared<AnomalyAlertQueue>())
+      : AnomalyDetector(Config{}, std::move(queue)) {}
+
+  AnomalyDetector(const Config& config,
+                  std::shared_ptr<AnomalyAlertQueue> queue)
+      : config_(config), queue_(std::move(queue)) {}
+
+  // Учесть проведённую операцию и при необходимости выпустить сигнал
+  void observe(const Operation& operation) {
+    observeAt(operation, Clock::now());
+  }
+
+  // arrival — момент поступления операции, по нему затухает счётчик
+  // всплесков
+  void observeAt(const Operation& operation, Clock::time_point arrival) {
+    double amount = operation.getAmount().getAmount();
+    double seconds =
+        std::chrono::duration<double>(arrival - started_).count();
+    const Id& accountId = operation.getBankAccountId();
+
+    std::vector<AnomalyAlert> alerts;
+    if (operation.isExpense()) {
+      const Id& categoryId = operation.getCategoryId();
+      uint64_t hash = hashKey(accountId, categoryId);
+      Shard& shard = shardOf(hash);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      observeAmount(shard.amountStats.findOrInsert(hash, accountId, categoryId),
+                    operation, amount, alerts);
+    }
+
+    {
+      static const Id NO_CATEGORY;
+      uint64_t hash = hashKey(accountId, NO_CATEGORY);
+      Shard& shard = shardOf(hash);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      observeBurst(shard.burstStats.findOrInsert(hash, accountId, NO_CATEGORY),
+                   operation, amount, seconds, alerts);
+    }
+
+    for (auto& alert : alerts) {
+      queue_->push(std::move(alert));
+    }
+  }
+
+  std::shared_ptr<AnomalyAlertQueue> getQueue() const { return queue_; }
+
+  size_t trackedSeries() {
+    size_t total = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      total += shard.amountStats.size();
+    }
+    return total;
+  }
+
+ private:
+  // Номер части берётся из старших битов: младшие выбирают ячейку таблицы
+  Shard& shardOf(uint64_t hash) { return shards_[(hash >> 32) % SHARDS]; }
+
+  void observeAmount(Slot& stats, const Operation& operation, double amount,
+                     std::vector<AnomalyAlert>& alerts) {
+    if (stats.observations >= config_.warmupObservations &&
+        stats.variance > 0) {
+      double score = (amount - stats.mean) / std::sqrt(stats.variance);
+      if (score > config_.zScoreThreshold) {
+        alerts.push_back({AnomalyAlert::Kind::AMOUNT_SPIKE, operation.getId(),
+                          operation.getBankAccountId(),
+                          operation.getCategoryId(), operation.getDate(),
+                          amount, stats.mean, score});
+      }
+    }
+
+    if (stats.observations == 0) {
+      stats.mean = amount;
+      stats.variance = 0;
+    } else {
+      double diff = amount - stats.mean;
+      double increment = config_.alpha * diff;
+      stats.mean += increment;
+      stats.variance = (1 - config_.alpha) * (stats.variance + diff * increment);
+    }
+    stats.observations++;
+  }
+
+  // Счётчик операций затухает с периодом полураспада burstHalfLifeSeconds;
+  // сигнал выдаётся один раз при пересечении порога
+  void observeBurst(Slot& burst, const Operation& operation, double amount,
+                    double seconds, std::vector<AnomalyAlert>& alerts) {
+    double elapsed = std::max(0.0, seconds - burst.lastSeconds);
+    double decay = burst.observations == 0
+                       ? 0.0
+                       : std::exp2(-elapsed / config_.burstHalfLifeSeconds);
+    burst.mean = burst.mean * decay + 1.0;
+    burst.lastSeconds = std::max(burst.lastSeconds, seconds);
+    burst.observations++;
+
+    if (burst.mean > config_.burstThreshold) {
+      if (!burst.burstReported) {
+        burst.burstReported = true;
+        alerts.push_back({AnomalyAlert::Kind::BURST, operation.getId(),
+                          operation.getBankAccountId(),
+                          operation.getCategoryId(), operation.getDate(),
+                          amount, config_.burstThreshold, burst.mean});
+      }
+    } else if (burst.mean < config_.burstThreshold / 2) {
+      burst.burstReported = false;
+    }
+  }
+
+  static uint64_t hashKey(const Id& accountId, const Id& categoryId) {
+    uint64_t h = std::hash<std::string>{}(accountId);
+    h ^= std::hash<std::string>{}(categoryId) + 0x9e3779b97f4a7c15ULL +
+         (h << 6) + (h >> 2);
+    return h == 0 ? 1 : h;
+  }
+};
+
+}  // namespace financial::domain
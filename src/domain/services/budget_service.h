@@ -0,0 +1,374 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/error_codes.h"
+#include "common/exceptions.h"
+#include "common/types.h"
+#include "common/validation.h"
+#include "domain/entities/operation.h"
+#include "domain/repositories/repository_interfaces.h"
+#include "domain/value_objects/money.h"
+
+namespace financial::domain {
+
+// Что делать при превышении месячного бюджета
+enum class BudgetPolicy {
+  WARN,   // провести операцию и сообщить обработчику предупреждений
+  REJECT  // отклонить операцию
+};
+
+enum class BudgetScope { CATEGORY, ACCOUNT };
+
+struct BudgetStatus {
+  BudgetScope scope;
+  Id scopeId;
+  Money limit;
+  Money spent;  // расход с начала месяца с учётом проверяемой операции
+  BudgetPolicy policy;
+  bool exceeded;
+};
+
+// Сервис месячных бюджетов по категориям и счетам.
+// Вместо просмотра операций хранит счётчики расходов по месяцам,
+// которые обновляются при проведении, импорте, удалении и изменении
+// операций, поэтому проверка лимита — один поиск в хеш-таблице и в
+// небольшом отображении месяц → сумма. Суммы ведутся отдельно по
+// валютам, с лимитом сравнивается только расход в его валюте. При
+// установке лимита расход текущего месяца берётся из репозитория операций.
+class BudgetService {
+ public:
+  using WarningHandler = std::function<void(const BudgetStatus&)>;
+
+ private:
+  // Сколько последних месяцев помнит счётчик
+  static constexpr size_t MAX_TRACKED_MONTHS = 24;
+
+  using MonthlySpend = std::map<int, double>;
+
+  struct Counter {
+    std::optional<Money> limit;
+    BudgetPolicy policy = BudgetPolicy::WARN;
+    // Валют у счётчика одна-две, линейный поиск дешевле хеширования
+    std::vector<std::pair<CurrencyCode, MonthlySpend>> spentByCurrency;
+
+    MonthlySpend& spentIn(const CurrencyCode& currency) {
+      for (auto& [code, months] : spentByCurrency) {
+        if (code == currency) return months;
+      }
+      return spentByCurrency.emplace_back(currency, MonthlySpend{}).second;
+    }
+
+    double spentIn(const CurrencyCode& currency, int month) const {
+      for (const auto& [code, months] : spentByCurrency) {
+        if (code != currency) continue;
+        auto it = months.find(month);
+        return it == months.end() ? 0 : it->second;
+      }
+      return 0;
+    }
+  };
+
+  std::shared_ptr<IOperationRepository> operationRepo_;
+  mutable std::mutex mutex_;
+  std::unordered_map<Id, Counter> categoryCounters_;
+  std::unordered_map<Id, Counter> accountCounters_;
+  WarningHandler warningHandler_;
+
+ public:
+  // Без репозитория счётчики знают только о переданных сервису операциях
+  explicit BudgetService(
+      std::shared_ptr<IOperationRepository> operationRepo = nullptr)
+      : operationRepo_(std::move(operationRepo)) {}
+
+  // Управление лимитами
+  void setCategoryBudget(const Id& categoryId, const Money& limit,
+                         BudgetPolicy policy = BudgetPolicy::WARN) {
+    OperationFilter filter;
+    filter.categoryIds.push_back(categoryId);
+    setLimit(categoryCounters_, categoryId, limit, policy, filter);
+  }
+
+  void setAccountBudget(const Id& accountId, const Money& limit,
+                        BudgetPolicy policy = BudgetPolicy::WARN) {
+    OperationFilter filter;
+    filter.accountIds.push_back(accountId);
+    setLimit(accountCounters_, accountId, limit, policy, filter);
+  }
+
+  void removeCategoryBudget(const Id& categoryId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = categoryCounters_.find(categoryId);
+    if (it != categoryCounters_.end()) it->second.limit.reset();
+  }
+
+  void removeAccountBudget(const Id& accountId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = accountCounters_.find(accountId);
+    if (it != accountCounters_.end()) it->second.limit.reset();
+  }
+
+  void setWarningHandler(WarningHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    warningHandler_ = std::move(handler);
+  }
+
+  // Проверить расход и сразу учесть его в счётчиках.
+  // При превышении лимита с политикой REJECT счётчики не меняются
+  // и бросается BudgetExceededException.
+  void applyExpense(const Operation& operation) {
+    BudgetStatus rejected{};
+    if (tryApplyExpense(operation, &rejected) != ErrorCode::NONE) {
+      raiseBudgetExceeded(rejected);
+    }
+  }
+
+  // Вариант без исключений: при отказе возвращает BUDGET_EXCEEDED,
+  // а состояние отклонившего бюджета записывает в rejected
+  ErrorCode tryApplyExpense(const Operation& operation,
+                            BudgetStatus* rejected = nullptr) {
+    if (!operation.isExpense()) return ErrorCode::NONE;
+
+    int month = monthKeyOf(operation.getDate());
+    double amount = operation.getAmount().getAmount();
+    std::optional<BudgetStatus> categoryWarning;
+    std::optional<BudgetStatus> accountWarning;
+    WarningHandler handler;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& category = categoryCounters_[operation.getCategoryId()];
+      auto& account = accountCounters_[operation.getBankAccountId()];
+
+      auto categoryStatus = evaluate(category, BudgetScope::CATEGORY,
+                                     operation.getCategoryId(), operation,
+                                     month, amount);
+      auto accountStatus = evaluate(account, BudgetScope::ACCOUNT,
+                                    operation.getBankAccountId(), operation,
+                                    month, amount);
+
+      for (const auto* status : {&categoryStatus, &accountStatus}) {
+        if (isRejected(*status)) {
+          if (rejected) *rejected = **status;
+          return ErrorCode::BUDGET_EXCEEDED;
+        }
+      }
+
+      const auto& currency = operation.getAmount().getCurrencyCode();
+      add(category, currency, month, amount);
+      add(account, currency, month, amount);
+
+      if (categoryStatus && categoryStatus->exceeded) {
+        categoryWarning = categoryStatus;
+      }
+      if (accountStatus && accountStatus->exceeded) {
+        accountWarning = accountStatus;
+      }
+      handler = warningHandler_;
+    }
+
+    if (handler) {
+      if (categoryWarning) handler(*categoryWarning);
+      if (accountWarning) handler(*accountWarning);
+    }
+    return ErrorCode::NONE;
+  }
+
+  // Бросить исключение по состоянию, полученному из tryApplyExpense
+  [[noreturn]] static void raiseBudgetExceeded(const BudgetStatus& status) {
+    std::string scope = status.scope == BudgetScope::CATEGORY ? "category "
+                                                              : "account ";
+    throw BudgetExceededException(scope + status.scopeId,
+                                  status.limit.getAmount(),
+                                  status.spent.getAmount());
+  }
+
+  // Учесть уже проведённый расход без проверки лимита (импорт)
+  void recordExpense(const Operation& operation) {
+    adjustExpense(operation, operation.getAmount());
+  }
+
+  // Операция удалена или не была проведена
+  void revertExpense(const Operation& operation) {
+    adjustExpense(operation, operation.getAmount(), -1);
+  }
+
+  // Сумма операции изменилась с previousAmount на текущую;
+  // при смене валюты старая сумма снимается со своей валюты
+  void updateExpense(const Operation& operation, const Money& previousAmount) {
+    if (!previousAmount.hasSameCurrency(operation.getAmount())) {
+      adjustExpense(operation, previousAmount, -1);
+      adjustExpense(operation, operation.getAmount());
+      return;
+    }
+    adjustExpense(operation,
+                  Money(operation.getAmount().getAmount() -
+                            previousAmount.getAmount(),
+                        previousAmount.getCurrencyCode()));
+  }
+
+  // Текущее состояние бюджета на месяц, в который попадает date
+  std::optional<BudgetStatus> getCategoryStatus(
+      const Id& categoryId, const DateTime& date = DateTimeUtils::now()) const {
+    return status(categoryCounters_, BudgetScope::CATEGORY, categoryId, date);
+  }
+
+  std::optional<BudgetStatus> getAccountStatus(
+      const Id& accountId, const DateTime& date = DateTimeUtils::now()) const {
+    return status(accountCounters_, BudgetScope::ACCOUNT, accountId, date);
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    categoryCounters_.clear();
+    accountCounters_.clear();
+  }
+
+  // localtime_r: вызывается из разных потоков вне mutex_
+  static int monthKeyOf(const DateTime& date) {
+    auto time = std::chrono::system_clock::to_time_t(date);
+    std::tm tm{};
+    localtime_r(&time, &tm);
+    return (tm.tm_year + 1900) * 12 + tm.tm_mon;
+  }
+
+  // Начало месяца monthKey по местному времени
+  static DateTime monthStart(int monthKey) {
+    std::tm tm{};
+    tm.tm_year = monthKey / 12 - 1900;
+    tm.tm_mon = monthKey % 12;
+    tm.tm_mday = 1;
+    tm.tm_isdst = -1;
+    return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+  }
+
+ private:
+  // Расход текущего месяца в валюте лимита пересчитывается по
+  // репозиторию: операции, проведённые до появления лимита или
+  // импортированные, уже учтены. Просмотр идёт под mutex_, иначе расходы,
+  // учтённые во время просмотра, были бы затёрты его результатом.
+  // Лимиты ставятся редко, а проводки ждут только на время одного
+  // просмотра по счёту или категории за месяц.
+  void setLimit(std::unordered_map<Id, Counter>& counters, const Id& id,
+                const Money& limit, BudgetPolicy policy,
+                OperationFilter filter) {
+    Validator::validateId(id);
+    Validator::validatePositive(limit.getAmount(), "Budget limit");
+
+    int month = monthKeyOf(DateTimeUtils::now());
+    const auto& currency = limit.getCurrencyCode();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& counter = counters[id];
+    counter.limit = limit;
+    counter.policy = policy;
+    if (operationRepo_) {
+      filter.period = DateRange(monthStart(month),
+                                monthStart(month + 1) - std::chrono::seconds(1));
+      double spent = 0;
+      operationRepo_->scan(filter, [&](const Operation& operation) {
+        if (operation.isExpense() &&
+            operation.getAmount().getCurrencyCode() == currency) {
+          spent += operation.getAmount().getAmount();
+        }
+      });
+      auto& months = counter.spentIn(currency);
+      months[month] = spent;
+      trim(months);
+    }
+  }
+
+  static bool isRejected(const std::optional<BudgetStatus>& status) {
+    return status && status->exceeded &&
+           status->policy == BudgetPolicy::REJECT;
+  }
+
+  static std::optional<BudgetStatus> evaluate(const Counter& counter,
+                                              BudgetScope scope, const Id& id,
+                                              const Operation& operation,
+                                              int month, double amount) {
+    if (!counter.limit ||
+        !counter.limit->hasSameCurrency(operation.getAmount())) {
+      return std::nullopt;
+    }
+
+    double spent =
+        counter.spentIn(counter.limit->getCurrencyCode(), month) + amount;
+    return BudgetStatus{scope,
+                        id,
+                        *counter.limit,
+                        Money(spent, counter.limit->getCurrencyCode()),
+                        counter.policy,
+                        spent > counter.limit->getAmount()};
+  }
+
+  // Каждый месяц считается отдельно: операция другого месяца
+  // не трогает суммы остальных
+  static void add(Counter& counter, const CurrencyCode& currency, int month,
+                  double amount) {
+    auto& months = counter.spentIn(currency);
+    double& spent = months[month];
+    spent = std::max(0.0, spent + amount);
+    trim(months);
+  }
+
+  // Старейшие месяцы вытесняются, отображение остаётся маленьким
+  static void trim(MonthlySpend& months) {
+    while (months.size() > MAX_TRACKED_MONTHS) {
+      months.erase(months.begin());
+    }
+  }
+
+  // Счётчики меняются на sign * amount в валюте amount
+  void adjustExpense(const Operation& operation, const Money& amount,
+                     int sign = 1) {
+    double delta = sign * amount.getAmount();
+    if (!operation.isExpense() || delta == 0) return;
+
+    int month = monthKeyOf(operation.getDate());
+    const auto& currency = amount.getCurrencyCode();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto* counters : {&categoryCounters_, &accountCounters_}) {
+      const Id& id = counters == &categoryCounters_
+                         ? operation.getCategoryId()
+                         : operation.getBankAccountId();
+      auto it = counters->find(id);
+      if (it != counters->end()) {
+        add(it->second, currency, month, delta);
+      } else if (delta > 0) {
+        add((*counters)[id], currency, month, delta);
+      }
+    }
+  }
+
+  std::optional<BudgetStatus> status(
+      const std::unordered_map<Id, Counter>& counters, BudgetScope scope,
+      const Id& id, const DateTime& date) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counters.find(id);
+    if (it == counters.end() || !it->second.limit) return std::nullopt;
+
+    const auto& counter = it->second;
+    double spent =
+        counter.spentIn(counter.limit->getCurrencyCode(), monthKeyOf(date));
+    return BudgetStatus{scope,
+                        id,
+                        *counter.limit,
+                        Money(spent, counter.limit->getCurrencyCode()),
+                        counter.policy,
+                        spent > counter.limit->getAmount()};
+  }
+};
+
+}  // namespace financial::domain
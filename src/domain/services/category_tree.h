@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/types.h"
+#include "domain/entities/category.h"
+
+namespace financial::domain {
+
+// Дерево категорий в интервальном представлении (Эйлеров обход).
+// Категории пронумерованы в порядке прямого обхода, поэтому поддерево
+// категории с позицией i занимает непрерывный диапазон [i, end(i)).
+// Проверка "A — предок B" и выборка "всё под Еда" сводятся к сравнению
+// позиций, а итоги по поддеревьям считаются одним обратным проходом.
+// Дерево — снимок: после изменения иерархии его строят заново.
+class CategoryTree {
+ public:
+  static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+ private:
+  std::vector<std::shared_ptr<Category>> nodes_;  // в порядке обхода
+  std::vector<size_t> parent_;
+  std::vector<size_t> end_;
+  std::vector<uint32_t> depth_;
+  std::unordered_map<Id, size_t> positions_;
+
+ public:
+  // Категории с отсутствующим родителем становятся корнями;
+  // цикл разрывается на первой встреченной категории цикла
+  explicit CategoryTree(
+      const std::vector<std::shared_ptr<Category>>& categories) {
+    size_t count = categories.size();
+    std::unordered_map<Id, size_t> inputIndex;
+    inputIndex.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      inputIndex.emplace(categories[i]->getId(), i);
+    }
+
+    std::vector<std::vector<size_t>> children(count);
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < count; ++i) {
+      auto parent = inputIndex.find(categories[i]->getParentId());
+      if (categories[i]->isRoot() || parent == inputIndex.end()) {
+        roots.push_back(i);
+      } else {
+        children[parent->second].push_back(i);
+      }
+    }
+
+    // Порядок обхода детерминирован: по имени, затем по id
+    auto byName = [&categories](size_t a, size_t b) {
+      const auto& left = *categories[a];
+      const auto& right = *categories[b];
+      if (left.getName() != right.getName()) {
+        return left.getName() < right.getName();
+      }
+      return left.getId() < right.getId();
+    };
+    std::sort(roots.begin(), roots.end(), byName);
+    for (auto& list : children) std::sort(list.begin(), list.end(), byName);
+
+    nodes_.reserve(count);
+    parent_.reserve(count);
+    end_.assign(count, 0);
+    depth_.reserve(count);
+    positions_.reserve(count);
+
+    std::vector<bool> visited(count, false);
+    for (size_t root : roots) traverse(categories, children, root, visited);
+
+    // Непосещённые категории лежат на циклах
+    for (size_t i = 0; i < count; ++i) {
+      if (!visited[i]) traverse(categories, children, i, visited);
+    }
+  }
+
+  size_t size() const { return nodes_.size(); }
+
+  std::optional<size_t> positionOf(const Id& categoryId) const {
+    auto it = positions_.find(categoryId);
+    if (it == positions_.end()) return std::nullopt;
+    return it->second;
+  }
+
+  const std::shared_ptr<Category>& at(size_t position) const {
+    return nodes_[position];
+  }
+
+  size_t parentOf(size_t position) const { return parent_[position]; }
+  uint32_t depthOf(size_t position) const { return depth_[position]; }
+  size_t subtreeEnd(size_t position) const { return end_[position]; }
+
+  // Диапазон позиций поддерева; пустой для неизвестной категории
+  std::pair<size_t, size_t> subtreeRange(const Id& categoryId) const {
+    auto position = positionOf(categoryId);
+    if (!position) return {0, 0};
+    return {*position, end_[*position]};
+  }
+
+  bool isAncestor(const Id& ancestorId, const Id& categoryId) const {
+    auto ancestor = positionOf(ancestorId);
+    auto category = positionOf(categoryId);
+    return ancestor && category && *ancestor <= *category &&
+           *category < end_[*ancestor];
+  }
+
+  // Перенос categoryId под newParentId замкнёт цикл
+  bool wouldCreateCycle(const Id& categoryId, const Id& newParentId) const {
+    return categoryId == newParentId || isAncestor(categoryId, newParentId);
+  }
+
+  std::vector<std::shared_ptr<Category>> subtree(const Id& categoryId) const {
+    auto [begin, end] = subtreeRange(categoryId);
+    return {nodes_.begin() + begin, nodes_.begin() + end};
+  }
+
+  // Итоги по поддеревьям из собственных значений узлов (по позициям).
+  // Родитель всегда стоит раньше потомков, поэтому одного прохода
+  // от конца к началу достаточно.
+  template <typename T, typename Combine>
+  std::vector<T> rollup(std::vector<T> values, Combine combine) const {
+    for (size_t i = values.size(); i-- > 0;) {
+      if (parent_[i] != NPOS) combine(values[parent_[i]], values[i]);
+    }
+    return values;
+  }
+
+ private:
+  void traverse(const std::vector<std::shared_ptr<Category>>& categories,
+                const std::vector<std::vector<size_t>>& children, size_t root,
+                std::vector<bool>& visited) {
+    struct Frame {
+      size_t node;      // индекс во входном списке
+      size_t position;  // позиция в обходе
+      size_t next;      // следующий ребёнок
+    };
+
+    std::vector<Frame> stack;
+    visited[root] = true;
+    stack.push_back({root, enter(categories[root], NPOS, 0), 0});
+
+    while (!stack.empty()) {
+      Frame& frame = stack.back();
+      if (frame.next < children[frame.node].size()) {
+        size_t child = children[frame.node][frame.next++];
+        if (visited[child]) continue;
+        visited[child] = true;
+        size_t parent = frame.position;
+        stack.push_back(
+            {child, enter(categories[child], parent, depth_[parent] + 1), 0});
+      } else {
+        end_[frame.position] = nodes_.size();
+        stack.pop_back();
+      }
+    }
+  }
+
+  size_t enter(const std::shared_ptr<Category>& category, size_t parent,
+               uint32_t depth) {
+    size_t position = nodes_.size();
+    positions_.emplace(category->getId(), position);
+    nodes_.push_back(category);
+    parent_.push_back(parent);
+    depth_.push_back(depth);
+    return position;
+  }
+};
+
+}  // namespace financial::domain
@@ -1,13 +1,23 @@
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
+#include "common/error_codes.h"
+#include "common/thread_pool.h"
+#include "common/quantile_sketch.h"
 #include "domain/entities/bank_account.h"
 #include "domain/entities/category.h"
 #include "domain/entities/operation.h"
 #include "domain/repositories/repository_interfaces.h"
+#include "domain/services/account_lock_service.h"
+#include "domain/services/aggregation.h"
+#include "domain/services/anomaly_detection.h"
+#include "domain/services/budget_service.h"
+#include "domain/services/category_tree.h"
 #include "domain/value_objects/date_range.h"
 #include "domain/factories/entity_factory.h"
 
@@ -31,6 +41,73 @@ struct PeriodAnalytics {
   std::vector<CategoryAnalytics> expenseByCategory;
 };
 
+// Итоги категории в дереве: собственные и по всему поддереву
+struct CategoryRollup {
+  Id categoryId;
+  std::string categoryName;
+  Id parentId;
+  size_t depth;
+  Money ownAmount;
+  Money subtreeAmount;
+  size_t ownCount;
+  size_t subtreeCount;
+};
+
+// Распределение сумм операций: квантили, гистограмма и выбросы
+struct AmountDistribution {
+  size_t count = 0;
+  double min = 0;
+  double max = 0;
+  double mean = 0;
+  double median = 0;
+  double p90 = 0;
+  double p99 = 0;
+  // Границы Тьюки: всё, что вне [lowerFence, upperFence], считается выбросом
+  double lowerFence = 0;
+  double upperFence = 0;
+  std::vector<HistogramBin> histogram;
+  std::vector<Id> outlierOperationIds;
+
+  static AmountDistribution fromSketch(const QuantileSketch& sketch,
+                                       size_t histogramBins) {
+    AmountDistribution result;
+    if (sketch.empty()) return result;
+
+    result.count = sketch.count();
+    result.min = sketch.min();
+    result.max = sketch.max();
+    result.mean = sketch.mean();
+    result.median = sketch.median();
+    result.p90 = sketch.quantile(0.90);
+    result.p99 = sketch.quantile(0.99);
+
+    double q1 = sketch.quantile(0.25);
+    double q3 = sketch.quantile(0.75);
+    result.lowerFence = q1 - 1.5 * (q3 - q1);
+    result.upperFence = q3 + 1.5 * (q3 - q1);
+    result.histogram = sketch.histogram(histogramBins);
+    return result;
+  }
+
+  bool isOutlier(double amount) const {
+    return count > 0 && (amount < lowerFence || amount > upperFence);
+  }
+};
+
+struct CategoryDistribution {
+  Id categoryId;
+  std::string categoryName;
+  OperationType type;
+  AmountDistribution distribution;
+};
+
+struct PeriodDistribution {
+  DateRange period;
+  AmountDistribution income;
+  AmountDistribution expense;
+  std::vector<CategoryDistribution> byCategory;
+};
+
 struct AccountBalance {
   Id accountId;
   std::string accountName;
@@ -44,69 +121,124 @@ class AnalyticsService {
  private:
   std::shared_ptr<IOperationRepository> operationRepo_;
   std::shared_ptr<ICategoryRepository> categoryRepo_;
+  std::shared_ptr<ThreadPool> pool_;
+
+  // Сгруппированные суммы -> отсортированный по id категории список с долями.
+  // Категории в разных валютах не складываются: Money::add бросает исключение
+  std::vector<CategoryAnalytics> toCategoryAnalytics(
+      const std::unordered_map<Id, aggregation::SumAndCount::State>& groups,
+      Money& total) {
+    aggregation::SumAndCount::State sum;
+    for (const auto& [id, state] : groups) {
+      aggregation::SumAndCount::merge(sum, state);
+    }
+    total = sum.total;
+
+    std::vector<CategoryAnalytics> result;
+    result.reserve(groups.size());
+    for (const auto& [id, state] : groups) {
+      auto category = categoryRepo_->findById(id);
+      CategoryAnalytics analytics{};
+      analytics.categoryId = id;
+      analytics.categoryName = category ? (*category)->getName() : "Unknown";
+      analytics.totalAmount = state.total;
+      analytics.operationCount = state.count;
+      if (!total.isZero()) {
+        analytics.percentage =
+            (state.total.getAmount() / total.getAmount()) * 100;
+      }
+      result.push_back(std::move(analytics));
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const CategoryAnalytics& a, const CategoryAnalytics& b) {
+                return a.categoryId < b.categoryId;
+              });
+    return result;
+  }
+
+  // Частичные результаты по частям хранилища операций: каждая часть
+  // обходится отдельной задачей пула под своей блокировкой, затем
+  // результаты сливаются. На нескольких узлах NUMA задача части идёт
+  // на рабочего узла, где лежит её индекс; на одном узле — в общую
+  // очередь. Без пула части обходятся по очереди в вызывающем потоке
+  template <typename State, typename Fn>
+  std::vector<State> scanPartitions(const OperationFilter& scope, Fn fn) {
+    size_t partitions = operationRepo_->partitionCount();
+    std::vector<State> partial(partitions);
+    bool numa = pool_ && pool_->nodeCount() > 1;
+
+    TaskGroup group(pool_.get());
+    for (size_t partition = 0; partition < partitions; ++partition) {
+      auto scan = [&, partition]() {
+        State local{};
+        operationRepo_->scanPartition(
+            partition, scope,
+            [&](const Operation& operation) { fn(local, operation); });
+        partial[partition] = std::move(local);
+      };
+      if (numa) {
+        group.runOnNode(operationRepo_->partitionNode(partition), scan);
+      } else {
+        group.run(scan);
+      }
+    }
+    group.wait();
+    return partial;
+  }
 
  public:
   AnalyticsService(std::shared_ptr<IOperationRepository> operationRepo,
-                   std::shared_ptr<ICategoryRepository> categoryRepo)
-      : operationRepo_(operationRepo), categoryRepo_(categoryRepo) {}
+                   std::shared_ptr<ICategoryRepository> categoryRepo,
+                   std::shared_ptr<ThreadPool> pool = nullptr)
+      : operationRepo_(operationRepo),
+        categoryRepo_(categoryRepo),
+        pool_(std::move(pool)) {}
 
   // Посчитать аналитику расходов и доходов за определённый период
   PeriodAnalytics calculatePeriodAnalytics(const DateRange& period) {
+    using namespace aggregation;
+    using IncomeByCategory =
+        Aggregate<ByCategory, SumAndCount,
+                  Both<FilterType<OperationType::INCOME>, FilterPeriod>>;
+    using ExpenseByCategory =
+        Aggregate<ByCategory, SumAndCount,
+                  Both<FilterType<OperationType::EXPENSE>, FilterPeriod>>;
+
+    struct Groups {
+      IncomeByCategory::Result income;
+      ExpenseByCategory::Result expense;
+    };
+
     PeriodAnalytics result{};
     result.period = period;
-    result.totalIncome = Money::zero();
-    result.totalExpense = Money::zero();
-
-    // Получаем операции за период
-    auto operations =
-        operationRepo_->findByDateRange(period.getStart(), period.getEnd());
-
-    // Группировка по категории операций (доходы/расходы)
-    std::map<Id, CategoryAnalytics> incomeMap;
-    std::map<Id, CategoryAnalytics> expenseMap;
-
-    for (const auto& op : operations) {
-      if (!op->isInDateRange(period)) continue;
-
-      auto& targetMap = op->isIncome() ? incomeMap : expenseMap;
-      auto& analytics = targetMap[op->getCategoryId()];
-
-      if (analytics.categoryId.empty()) {
-        analytics.categoryId = op->getCategoryId();
-        auto category = categoryRepo_->findById(op->getCategoryId());
-        analytics.categoryName = category ? (*category)->getName() : "Unknown";
-        analytics.totalAmount = Money::zero(op->getAmount().getCurrency());
-        analytics.operationCount = 0;
-      }
-
-      analytics.totalAmount = analytics.totalAmount.add(op->getAmount());
-      analytics.operationCount++;
 
-      if (op->isIncome()) {
-        result.totalIncome = result.totalIncome.add(op->getAmount());
-      } else {
-        result.totalExpense = result.totalExpense.add(op->getAmount());
-      }
+    // Группировка по категории отдельно для доходов и расходов: каждая
+    // часть хранилища сворачивается отдельно, затем итоги сливаются
+    OperationFilter scope;
+    scope.period = period;
+    auto partial = scanPartitions<Groups>(
+        scope, [&period](Groups& groups, const Operation& operation) {
+          IncomeByCategory::add(groups.income, operation, {{}, {period}});
+          ExpenseByCategory::add(groups.expense, operation, {{}, {period}});
+        });
+
+    IncomeByCategory::Result income;
+    ExpenseByCategory::Result expense;
+    for (const auto& groups : partial) {
+      IncomeByCategory::merge(income, groups.income);
+      ExpenseByCategory::merge(expense, groups.expense);
     }
 
-    for (auto& [id, analytics] : incomeMap) {
-      if (!result.totalIncome.isZero()) {
-        analytics.percentage = (analytics.totalAmount.getAmount() /
-                                result.totalIncome.getAmount()) *
-                               100;
-      }
-      result.incomeByCategory.push_back(analytics);
+    result.incomeByCategory = toCategoryAnalytics(income, result.totalIncome);
+    result.expenseByCategory =
+        toCategoryAnalytics(expense, result.totalExpense);
+    // Пустая сторона берёт валюту другой, иначе вычитание не сойдётся
+    if (income.empty()) {
+      result.totalIncome = Money(0, result.totalExpense.getCurrencyCode());
+    } else if (expense.empty()) {
+      result.totalExpense = Money(0, result.totalIncome.getCurrencyCode());
     }
-
-    for (auto& [id, analytics] : expenseMap) {
-      if (!result.totalExpense.isZero()) {
-        analytics.percentage = (analytics.totalAmount.getAmount() /
-                                result.totalExpense.getAmount()) *
-                               100;
-      }
-      result.expenseByCategory.push_back(analytics);
-    }
-
     result.netIncome = result.totalIncome.subtract(result.totalExpense);
 
     return result;
@@ -133,18 +265,163 @@ class AnalyticsService {
 
     return categories;
   }
+
+  // Итоги по дереву категорий в порядке обхода (родитель перед детьми).
+  // Операции группируются по категории за один проход, затем суммы
+  // поднимаются к корням одним обратным проходом по дереву.
+  std::vector<CategoryRollup> calculateCategoryRollups(const DateRange& period,
+                                                       OperationType type) {
+    using namespace aggregation;
+    using ByCategoryInPeriod =
+        Aggregate<ByCategory, SumAndCount,
+                  Both<FilterOperationType, FilterPeriod>>;
+
+    CategoryTree tree(categoryRepo_->findAll());
+    OperationFilter scope;
+    scope.period = period;
+    ByCategoryInPeriod::Result groups;
+    for (const auto& partial : scanPartitions<ByCategoryInPeriod::Result>(
+             scope, [&](ByCategoryInPeriod::Result& local,
+                        const Operation& operation) {
+               ByCategoryInPeriod::add(local, operation, {{type}, {period}});
+             })) {
+      ByCategoryInPeriod::merge(groups, partial);
+    }
+
+    std::vector<SumAndCount::State> own(tree.size());
+    for (const auto& [categoryId, state] : groups) {
+      if (auto position = tree.positionOf(categoryId)) own[*position] = state;
+    }
+
+    auto subtree = tree.rollup(own, [](SumAndCount::State& parent,
+                                       const SumAndCount::State& child) {
+      SumAndCount::merge(parent, child);
+    });
+
+    std::vector<CategoryRollup> result;
+    result.reserve(tree.size());
+    for (size_t i = 0; i < tree.size(); ++i) {
+      const auto& category = *tree.at(i);
+      result.push_back({category.getId(), category.getName(),
+                        category.getParentId(), tree.depthOf(i),
+                        own[i].total, subtree[i].total,
+                        own[i].count, subtree[i].count});
+    }
+    return result;
+  }
+
+  // Сумма операций по категории и всем её потомкам: поддерево — это
+  // непрерывный диапазон позиций, поэтому проверка операции — одно сравнение
+  Money calculateSubtreeTotal(const Id& categoryId, const DateRange& period,
+                              OperationType type) {
+    CategoryTree tree(categoryRepo_->findAll());
+    auto [begin, end] = tree.subtreeRange(categoryId);
+    if (begin == end) return Money::zero();
+
+    aggregation::SumAndCount::State total;
+    for (const auto& op :
+         operationRepo_->findByDateRange(period.getStart(), period.getEnd())) {
+      if (op->getType() != type) continue;
+      auto position = tree.positionOf(op->getCategoryId());
+      if (position && *position >= begin && *position < end) {
+        aggregation::SumAndCount::add(total, *op);
+      }
+    }
+    return total.total;
+  }
+
+  // Сумма и число операций, подходящих под запрос по тегам.
+  // Отбор по тегам выполняет индекс репозитория, здесь — только свёртка.
+  aggregation::SumAndCount::State calculateTaggedTotal(const TagQuery& query,
+                                                       const DateRange& period,
+                                                       OperationType type) {
+    using namespace aggregation;
+    using Total =
+        Aggregate<NoKey, SumAndCount, Both<FilterOperationType, FilterPeriod>>;
+    return Total::run(operationRepo_->findByTags(query), {{type}, {period}});
+  }
+
+  // Распределение сумм за период: по доходам, расходам и каждой категории.
+  // Квантили берутся из скетчей, построенных за один проход без сортировки;
+  // второй проход только отмечает выбросы по уже известным границам.
+  PeriodDistribution calculateAmountDistribution(const DateRange& period,
+                                                 size_t histogramBins = 10) {
+    PeriodDistribution result{};
+    result.period = period;
+
+    auto operations =
+        operationRepo_->findByDateRange(period.getStart(), period.getEnd());
+
+    QuantileSketch incomeSketch;
+    QuantileSketch expenseSketch;
+    std::map<std::pair<Id, OperationType>, QuantileSketch> categorySketches;
+
+    for (const auto& op : operations) {
+      if (!op->isInDateRange(period)) continue;
+
+      double amount = op->getAmount().getAmount();
+      (op->isIncome() ? incomeSketch : expenseSketch).add(amount);
+      categorySketches[{op->getCategoryId(), op->getType()}].add(amount);
+    }
+
+    result.income = AmountDistribution::fromSketch(incomeSketch, histogramBins);
+    result.expense =
+        AmountDistribution::fromSketch(expenseSketch, histogramBins);
+
+    std::map<std::pair<Id, OperationType>, size_t> positions;
+    for (const auto& [key, sketch] : categorySketches) {
+      CategoryDistribution distribution;
+      distribution.categoryId = key.first;
+      distribution.type = key.second;
+      auto category = categoryRepo_->findById(key.first);
+      distribution.categoryName =
+          category ? (*category)->getName() : "Unknown";
+      distribution.distribution =
+          AmountDistribution::fromSketch(sketch, histogramBins);
+
+      positions[key] = result.byCategory.size();
+      result.byCategory.push_back(std::move(distribution));
+    }
+
+    for (const auto& op : operations) {
+      if (!op->isInDateRange(period)) continue;
+
+      double amount = op->getAmount().getAmount();
+      auto& total = op->isIncome() ? result.income : result.expense;
+      if (total.isOutlier(amount)) {
+        total.outlierOperationIds.push_back(op->getId());
+      }
+
+      auto& category =
+          result.byCategory[positions[{op->getCategoryId(), op->getType()}]]
+              .distribution;
+      if (category.isOutlier(amount)) {
+        category.outlierOperationIds.push_back(op->getId());
+      }
+    }
+
+    return result;
+  }
 };
 
 class BalanceReconciliationService {
  private:
   std::shared_ptr<IBankAccountRepository> accountRepo_;
   std::shared_ptr<IOperationRepository> operationRepo_;
+  std::shared_ptr<ThreadPool> pool_;
+  std::shared_ptr<AccountLockService> accountLocks_;
 
  public:
   BalanceReconciliationService(
       std::shared_ptr<IBankAccountRepository> accountRepo,
-      std::shared_ptr<IOperationRepository> operationRepo)
-      : accountRepo_(accountRepo), operationRepo_(operationRepo) {}
+      std::shared_ptr<IOperationRepository> operationRepo,
+      std::shared_ptr<ThreadPool> pool = nullptr,
+      std::shared_ptr<AccountLockService> accountLocks = nullptr)
+      : accountRepo_(accountRepo),
+        operationRepo_(operationRepo),
+        pool_(std::move(pool)),
+        accountLocks_(accountLocks ? std::move(accountLocks)
+                                   : std::make_shared<AccountLockService>()) {}
 
   // Проверка что текущий баланс на счёте соответствует
   // проведённым на нём операциям
@@ -178,8 +455,10 @@ class BalanceReconciliationService {
     return result;
   }
 
-  // Пересчитать и исправить баланс
+  // Пересчитать и исправить баланс. Проверка и исправление идут под
+  // блокировкой счёта: проводка между ними не потеряется
   void recalculateBalance(const Id& accountId, bool autoFix = false) {
+    auto lock = accountLocks_->lock(accountId);
     auto result = checkAccountBalance(accountId);
 
     if (result.hasDiscrepancy && autoFix) {
@@ -193,51 +472,128 @@ class BalanceReconciliationService {
 
   // Возвращает список объектов AccountBalance, где есть сумма по операциям
   // и предполагаемый баланс
+  // Счета проверяются независимо, поэтому — параллельно в пуле;
+  // порядок результатов совпадает с порядком findAll
   std::vector<AccountBalance> checkAllBalances() {
-    std::vector<AccountBalance> results;
     auto accounts = accountRepo_->findAll();
+    std::vector<AccountBalance> results(accounts.size());
 
-    for (const auto& account : accounts) {
-      results.push_back(checkAccountBalance(account->getId()));
-    }
+    parallelFor(pool_.get(), 0, accounts.size(), 1,
+                [&](size_t from, size_t to) {
+                  for (size_t i = from; i < to; ++i) {
+                    results[i] = checkAccountBalance(accounts[i]->getId());
+                  }
+                });
 
     return results;
   }
 };
 
 
+// Версии счетов и операций до и после проводки: по ним её можно
+// отменить восстановлением прежних версий (IRepository::restore)
+struct PostingSnapshots {
+  RepositorySnapshot<BankAccount> accountsBefore;
+  RepositorySnapshot<BankAccount> accountsAfter;
+  RepositorySnapshot<Operation> operationsBefore;
+  RepositorySnapshot<Operation> operationsAfter;
+};
+
 // Доменный сервис для проведения операций
 class OperationProcessingService {
  private:
   std::shared_ptr<IBankAccountRepository> accountRepo_;
   std::shared_ptr<IOperationRepository> operationRepo_;
   std::shared_ptr<IEntityFactory> entityFactory_;
+  std::shared_ptr<AnomalyDetector> anomalyDetector_;
+  std::shared_ptr<BudgetService> budgetService_;
+  std::shared_ptr<AccountLockService> accountLocks_;
 
  public:
   OperationProcessingService(
       std::shared_ptr<IBankAccountRepository> accountRepo,
       std::shared_ptr<IOperationRepository> operationRepo,
-      std::shared_ptr<IEntityFactory> entityFactory)
+      std::shared_ptr<IEntityFactory> entityFactory,
+      std::shared_ptr<AnomalyDetector> anomalyDetector = nullptr,
+      std::shared_ptr<BudgetService> budgetService = nullptr,
+      std::shared_ptr<AccountLockService> accountLocks = nullptr)
       : accountRepo_(accountRepo),
         operationRepo_(operationRepo),
-        entityFactory_(entityFactory) {}
+        entityFactory_(entityFactory),
+        anomalyDetector_(anomalyDetector),
+        budgetService_(budgetService),
+        accountLocks_(accountLocks ? std::move(accountLocks)
+                                   : std::make_shared<AccountLockService>()) {}
+
+  // Выполнение конкретной операции. snapshots, если задан, получает
+  // версии репозиториев вокруг проводки
+  void processOperation(std::shared_ptr<Operation> operation,
+                        PostingSnapshots* snapshots = nullptr) {
+    BudgetStatus budgetRejection{};
+    auto status = tryProcessOperation(operation, &budgetRejection, snapshots);
+    if (status.isSuccess()) return;
+
+    switch (status.getError()) {
+      case ErrorCode::ACCOUNT_NOT_FOUND:
+        throw EntityNotFoundException("BankAccount",
+                                      operation->getBankAccountId());
+      case ErrorCode::BUDGET_EXCEEDED:
+        BudgetService::raiseBudgetExceeded(budgetRejection);
+      default: {
+        auto account = accountRepo_->findById(operation->getBankAccountId());
+        (*account)->raisePostingError(status.getError(),
+                                      operation->getAmount(),
+                                      operation->isIncome());
+      }
+    }
+  }
 
-  // Выполнение конкретной операции
-  void processOperation(std::shared_ptr<Operation> operation) {
+  // Проводка без исключений: отказ (нет счёта, превышен бюджет,
+  // недостаточно средств) возвращается кодом, состояние не меняется.
+  // При BUDGET_EXCEEDED состояние бюджета записывается в budgetRejection.
+  // Счёт меняется и сохраняется под его блокировкой из AccountLockService;
+  // снимки в snapshots снимаются под ней же, сразу до и после записи
+  Status tryProcessOperation(const std::shared_ptr<Operation>& operation,
+                             BudgetStatus* budgetRejection = nullptr,
+                             PostingSnapshots* snapshots = nullptr) {
+    auto lock = accountLocks_->lock(operation->getBankAccountId());
     auto account = accountRepo_->findById(operation->getBankAccountId());
-    if (!account) {
-      throw EntityNotFoundException("BankAccount",
-                                    operation->getBankAccountId());
+    if (!account) return errorStatus(ErrorCode::ACCOUNT_NOT_FOUND);
+
+    // Бюджет проверяется и резервируется до списания,
+    // при неудаче проводки резерв снимается
+    if (budgetService_) {
+      ErrorCode code = budgetService_->tryApplyExpense(*operation,
+                                                       budgetRejection);
+      if (code != ErrorCode::NONE) return errorStatus(code);
     }
 
-    if (operation->isIncome()) {
-      (*account)->deposit(operation->getAmount());
-    } else {
-      (*account)->withdraw(operation->getAmount());
+    auto posted = operation->isIncome()
+                      ? (*account)->tryDeposit(operation->getAmount())
+                      : (*account)->tryWithdraw(operation->getAmount());
+    if (posted.isFailure()) {
+      if (budgetService_) {
+        budgetService_->revertExpense(*operation);
+      }
+      return posted;
     }
 
+    if (snapshots) {
+      snapshots->accountsBefore = accountRepo_->snapshot();
+      snapshots->operationsBefore = operationRepo_->snapshot();
+    }
     operationRepo_->save(operation);
     accountRepo_->update(*account);
+    if (snapshots) {
+      snapshots->accountsAfter = accountRepo_->snapshot();
+      snapshots->operationsAfter = operationRepo_->snapshot();
+    }
+    lock.unlock();
+
+    if (anomalyDetector_) {
+      anomalyDetector_->observe(*operation);
+    }
+    return okStatus();
   }
 
   // Обработать регулярные операции
@@ -245,8 +601,26 @@ class OperationProcessingService {
     auto operations = operationRepo_->findWhere(
         [](const Operation& op) { return op.getIsRecurring(); });
 
+    OperationColumns columns;
+    columns.reserve(operations.size());
     for (const auto& op : operations) {
-      auto newOp = std::make_shared<Operation>(op->cloneForDate(currentDate));
+      columns.add(op->getType(), op->getBankAccountId(), op->getAmount(),
+                  op->getCategoryId(), op->occurrenceDescription(),
+                  currentDate);
+    }
+
+    // Отклонённая строка (например, описание с суффиксом превысило
+    // допустимую длину) — ошибка, как при клонировании по одной операции;
+    // в этом случае не проводится ни одна
+    auto batch = entityFactory_->createOperations(std::move(columns));
+    if (!batch.rejected.empty()) {
+      const auto& first = batch.rejected.front();
+      throw ValidationException(
+          "Recurring operation " + operations[first.row]->getId() + ": " +
+          errorCodeToString(first.code) + " (" +
+          std::to_string(batch.rejected.size()) + " rejected)");
+    }
+    for (const auto& newOp : batch.created) {
       processOperation(newOp);
     }
   }
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/types.h"
+#include "common/utils.h"
+#include "domain/entities/bank_account.h"
+#include "domain/entities/operation.h"
+#include "domain/repositories/repository_interfaces.h"
+
+namespace financial::domain {
+
+// Прогноз баланса на конец месяца
+struct MonthProjection {
+  DateTime monthEnd;
+  Money balance;
+  Money income;
+  Money expense;
+};
+
+// Среднедневной поток разовых операций категории по счёту
+struct CategoryAverage {
+  Id categoryId;
+  Money dailyIncome;
+  Money dailyExpense;
+};
+
+struct AccountForecast {
+  Id accountId;
+  std::string accountName;
+  Money startingBalance;
+  std::vector<MonthProjection> months;
+  Money minimumBalance;
+  DateTime minimumBalanceDate;
+  std::vector<CategoryAverage> categoryAverages;
+};
+
+// Расписание повторяющейся операции, раскрываемое по требованию
+class RecurrenceSchedule {
+ public:
+  enum class Pattern { NONE, WEEKLY, MONTHLY, YEARLY };
+
+ private:
+  Pattern pattern_;
+  std::tm anchor_{};
+  DateTime anchorTime_;
+  long step_ = 0;
+
+ public:
+  RecurrenceSchedule(const DateTime& anchor, const std::string& pattern)
+      : pattern_(parsePattern(pattern)), anchorTime_(anchor) {
+    auto time = std::chrono::system_clock::to_time_t(anchor);
+    localtime_r(&time, &anchor_);
+  }
+
+  bool isValid() const { return pattern_ != Pattern::NONE; }
+
+  // Перейти к первому повторению строго после date
+  void skipTo(const DateTime& date) {
+    if (pattern_ == Pattern::WEEKLY) {
+      auto elapsed = date - anchorTime_;
+      step_ = std::max<long>(
+          1, static_cast<long>(elapsed / std::chrono::hours(24 * 7)));
+    } else {
+      auto time = std::chrono::system_clock::to_time_t(date);
+      std::tm tm{};
+      localtime_r(&time, &tm);
+      long months = (tm.tm_year - anchor_.tm_year) * 12L +
+                    (tm.tm_mon - anchor_.tm_mon);
+      step_ = std::max<long>(1, pattern_ == Pattern::YEARLY ? months / 12
+                                                            : months);
+    }
+    while (current() <= date) step_++;
+  }
+
+  DateTime current() const {
+    switch (pattern_) {
+      case Pattern::WEEKLY:
+        return anchorTime_ + std::chrono::hours(24 * 7) * step_;
+      case Pattern::MONTHLY:
+        return addMonths(step_);
+      case Pattern::YEARLY:
+        return addMonths(step_ * 12);
+      default:
+        return anchorTime_;
+    }
+  }
+
+  DateTime next() {
+    step_++;
+    return current();
+  }
+
+  static Pattern parsePattern(const std::string& pattern) {
+    if (pattern == "WEEKLY") return Pattern::WEEKLY;
+    if (pattern == "MONTHLY") return Pattern::MONTHLY;
+    if (pattern == "YEARLY") return Pattern::YEARLY;
+    return Pattern::NONE;
+  }
+
+ private:
+  // День месяца сохраняется, но не выходит за конец короткого месяца.
+  // Сдвиг считается календарной арифметикой без mktime, время суток
+  // остаётся как у исходной операции.
+  DateTime addMonths(long months) const {
+    long total = anchor_.tm_mon + months;
+    int year = anchor_.tm_year + static_cast<int>(total / 12);
+    int month = static_cast<int>(total % 12);
+    int day = std::min(anchor_.tm_mday, daysInMonth(year, month));
+    long shift = daysFromCivil(year, month, day) -
+                 daysFromCivil(anchor_.tm_year, anchor_.tm_mon, anchor_.tm_mday);
+    return anchorTime_ + std::chrono::hours(24) * shift;
+  }
+
+  // Номер дня от 1970-01-01 (алгоритм Х. Хиннанта)
+  static long daysFromCivil(int tmYear, int tmMonth, int day) {
+    long y = tmYear + 1900 - (tmMonth < 2 ? 1 : 0);
+    long m = tmMonth + 1;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+  }
+
+  static int daysInMonth(int year, int month) {
+    static constexpr int DAYS[] = {31, 28, 31, 30, 31, 30,
+                                   31, 31, 30, 31, 30, 31};
+    int y = year + 1900;
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return month == 1 && leap ? 29 : DAYS[month];
+  }
+};
+
+// Сервис прогноза движения денежных средств.
+// Повторяющиеся операции раскрываются по расписанию, разовые операции
+// последних месяцев превращаются в среднедневной поток по категориям
+// счёта, поток счёта — сумма потоков его категорий. Уже проведённые
+// повторения (счёт, категория, тип и описание шаблона с суффиксом
+// RECURRING_SUFFIX) в средние не входят: их даёт расписание.
+// Все изменения складываются в общий массив [счёт × день], после чего
+// балансы считаются префиксными суммами по непрерывным строкам.
+class CashFlowForecastService {
+ private:
+  std::shared_ptr<IBankAccountRepository> accountRepo_;
+  std::shared_ptr<IOperationRepository> operationRepo_;
+
+  using Clock = std::chrono::system_clock;
+
+ public:
+  CashFlowForecastService(std::shared_ptr<IBankAccountRepository> accountRepo,
+                          std::shared_ptr<IOperationRepository> operationRepo)
+      : accountRepo_(accountRepo), operationRepo_(operationRepo) {}
+
+  std::vector<AccountForecast> forecast(size_t months,
+                                        const DateTime& from = DateTimeUtils::now(),
+                                        size_t historyMonths = 3) {
+    auto accounts = accountRepo_->findActive();
+    std::vector<AccountForecast> result;
+    if (accounts.empty() || months == 0) return result;
+
+    DateTime start = DateTimeUtils::startOfDay(from);
+    auto monthEnds = monthBoundaries(start, months);
+    size_t days = monthEnds.back() + 1;
+    size_t accountCount = accounts.size();
+
+    std::unordered_map<Id, size_t> rows;
+    rows.reserve(accountCount);
+    for (size_t i = 0; i < accountCount; ++i) {
+      rows[accounts[i]->getId()] = i;
+    }
+
+    // Изменения баланса по дням: строка на счёт, отдельно доходы и расходы
+    std::vector<double> income(accountCount * days, 0.0);
+    std::vector<double> expense(accountCount * days, 0.0);
+    std::vector<std::unordered_map<Id, CategoryRate>> categoryRates(
+        accountCount);
+
+    DateTime horizon = start + std::chrono::hours(24) * days;
+    DateTime historyStart = shiftMonths(start, -static_cast<long>(historyMonths));
+    double historyDays = std::max(
+        1.0, std::chrono::duration<double, std::ratio<86400>>(start - historyStart)
+                 .count());
+
+    auto operations = operationRepo_->findAll();
+    std::unordered_set<std::string> occurrences;
+    for (const auto& op : operations) {
+      if (op->getIsRecurring()) {
+        occurrences.insert(occurrenceKey(*op, op->occurrenceDescription()));
+      }
+    }
+
+    for (const auto& op : operations) {
+      auto row = rows.find(op->getBankAccountId());
+      if (row == rows.end()) continue;
+      size_t r = row->second;
+      if (op->getAmount().getCurrencyCode() != accounts[r]->getCurrencyCode()) continue;
+
+      double amount = op->getAmount().getAmount();
+      auto& target = op->isIncome() ? income : expense;
+
+      if (op->getIsRecurring()) {
+        RecurrenceSchedule schedule(op->getDate(), op->getRecurringPattern());
+        if (!schedule.isValid()) continue;
+        // Повторение ровно в начале первого дня тоже попадает в прогноз
+        schedule.skipTo(
+            std::max(op->getDate(), start - std::chrono::seconds(1)));
+        for (auto date = schedule.current(); date < horizon;
+             date = schedule.next()) {
+          target[r * days + dayIndex(start, date)] += amount;
+        }
+      } else if (op->getDate() >= historyStart && op->getDate() < start &&
+                 !occurrences.count(
+                     occurrenceKey(*op, op->getDescription()))) {
+        auto& rate = categoryRates[r][op->getCategoryId()];
+        (op->isIncome() ? rate.income : rate.expense) += amount / historyDays;
+      }
+    }
+
+    result.reserve(accountCount);
+    std::vector<double> balance(days);
+    for (size_t r = 0; r < accountCount; ++r) {
+      double* in = income.data() + r * days;
+      double* out = expense.data() + r * days;
+      double inRate = 0;
+      double outRate = 0;
+      for (const auto& [categoryId, rate] : categoryRates[r]) {
+        inRate += rate.income;
+        outRate += rate.expense;
+      }
+
+      for (size_t d = 0; d < days; ++d) {
+        in[d] += inRate;
+        out[d] += outRate;
+        balance[d] = in[d] - out[d];
+      }
+
+      double running = accounts[r]->getBalance().getAmount();
+      for (size_t d = 0; d < days; ++d) {
+        running += balance[d];
+        balance[d] = running;
+      }
+
+      result.push_back(buildForecast(*accounts[r], start, monthEnds, in, out,
+                                     balance, categoryRates[r]));
+    }
+
+    return result;
+  }
+
+ private:
+  struct CategoryRate {
+    double income = 0;
+    double expense = 0;
+  };
+
+  // Ключ, по которому повторение сопоставляется со своим шаблоном
+  static std::string occurrenceKey(const Operation& op,
+                                   const std::string& description) {
+    std::string key;
+    key.reserve(op.getBankAccountId().size() + op.getCategoryId().size() +
+                description.size() + 3);
+    key += op.getBankAccountId();
+    key += '\x1f';
+    key += op.getCategoryId();
+    key += '\x1f';
+    key += op.isIncome() ? 'I' : 'E';
+    key += description;
+    return key;
+  }
+
+  static size_t dayIndex(const DateTime& start, const DateTime& date) {
+    auto days = std::chrono::duration_cast<std::chrono::hours>(date - start)
+                    .count() / 24;
+    return static_cast<size_t>(std::max<long long>(0, days));
+  }
+
+  static DateTime shiftMonths(const DateTime& date, long months) {
+    auto time = Clock::to_time_t(date);
+    std::tm tm{};
+    localtime_r(&time, &tm);
+    long total = tm.tm_year * 12L + tm.tm_mon + months;
+    tm.tm_year = static_cast<int>(total / 12);
+    tm.tm_mon = static_cast<int>(total % 12);
+    tm.tm_mday = 1;
+    tm.tm_isdst = -1;
+    return Clock::from_time_t(std::mktime(&tm));
+  }
+
+  // Индексы последних дней каждого из months календарных месяцев
+  static std::vector<size_t> monthBoundaries(const DateTime& start,
+                                             size_t months) {
+    std::vector<size_t> ends;
+    ends.reserve(months);
+    for (size_t m = 1; m <= months; ++m) {
+      DateTime nextMonth = shiftMonths(start, static_cast<long>(m));
+      ends.push_back(std::max<size_t>(dayIndex(start, nextMonth), 1) - 1);
+    }
+    return ends;
+  }
+
+  static AccountForecast buildForecast(const BankAccount& account,
+                                       const DateTime& start,
+                                       const std::vector<size_t>& monthEnds,
+                                       const double* income,
+                                       const double* expense,
+                                       const std::vector<double>& balance,
+                                       const std::unordered_map<Id, CategoryRate>&
+                                           categoryRates) {
+    auto currency = account.getCurrencyCode();
+    AccountForecast forecast{account.getId(), account.getName(),
+                             account.getBalance(), {},
+                             Money(balance[0], currency), start, {}};
+
+    size_t monthStart = 0;
+    for (size_t end : monthEnds) {
+      double monthIncome = 0;
+      double monthExpense = 0;
+      for (size_t d = monthStart; d <= end; ++d) {
+        monthIncome += income[d];
+        monthExpense += expense[d];
+      }
+      forecast.months.push_back({start + std::chrono::hours(24) * end,
+                                 Money(balance[end], currency),
+                                 Money(monthIncome, currency),
+                                 Money(monthExpense, currency)});
+      monthStart = end + 1;
+    }
+
+    auto minIt = std::min_element(balance.begin(), balance.end());
+    forecast.minimumBalance = Money(*minIt, currency);
+    forecast.minimumBalanceDate =
+        start + std::chrono::hours(24) * (minIt - balance.begin());
+
+    forecast.categoryAverages.reserve(categoryRates.size());
+    for (const auto& [categoryId, rate] : categoryRates) {
+      forecast.categoryAverages.push_back({categoryId,
+                                           Money(rate.income, currency),
+                                           Money(rate.expense, currency)});
+    }
+    return forecast;
+  }
+};
+
+}  // namespace financial::domain
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common/types.h"
+#include "domain/entities/operation.h"
+
+namespace financial::domain {
+
+// Сопоставление строк банковской выписки с уже учтёнными операциями.
+// Повторный импорт пересекающихся выгрузок не должен создавать дубликаты,
+// но две одинаковые покупки в один день — это две операции. Поэтому
+// каждая учтённая операция может "поглотить" не больше одной строки.
+//
+// Учтённые операции сортируются по (группа, время), где группа — хеш
+// счёта, типа, суммы в копейках и валюты. Точное совпадение (та же группа,
+// то же время, то же нормализованное описание) находится по отпечатку
+// в хеш-таблице. Нечёткое совпадение ищется бинарным поиском внутри
+// группы в окне ±dateWindow. Итоговая сложность — O(n log n).
+//
+// Строка, принятая как новая, сразу попадает в индексы: её повтор дальше
+// в той же выписке — дубликат. Такие записи не расходуются, повтор
+// поглощается сколько угодно раз.
+class StatementMatcher {
+ public:
+  enum class MatchKind { NEW, EXACT_DUPLICATE, FUZZY_DUPLICATE };
+
+  struct Config {
+    std::chrono::seconds dateWindow = std::chrono::hours(24 * 2);
+  };
+
+ private:
+  struct Entry {
+    uint64_t group;
+    int64_t seconds;
+    uint64_t fingerprint;
+    std::string description;  // нормализованное
+    bool used = false;
+    bool accepted = false;  // строка этой выписки, не расходуется
+  };
+
+  Config config_;
+  std::vector<Entry> entries_;
+  std::unordered_map<uint64_t, std::pair<size_t, size_t>> groups_;
+  std::unordered_map<uint64_t, size_t> exact_;  // отпечаток -> первая запись
+
+  // Принятые строки выписки: группа -> записи, упорядоченные по времени
+  std::unordered_map<uint64_t, std::vector<Entry>> accepted_;
+  std::unordered_set<uint64_t> acceptedExact_;
+
+ public:
+  explicit StatementMatcher(
+      const std::vector<std::shared_ptr<Operation>>& existing)
+      : StatementMatcher(existing, Config{}) {}
+
+  StatementMatcher(const std::vector<std::shared_ptr<Operation>>& existing,
+                   Config config)
+      : config_(config) {
+    entries_.reserve(existing.size());
+    for (const auto& op : existing) {
+      Entry entry{groupKey(op->getBankAccountId(), op->getType(),
+                           op->getAmount()),
+                  toSeconds(op->getDate()), 0,
+                  normalizeDescription(op->getDescription())};
+      entry.fingerprint =
+          fingerprint(entry.group, entry.seconds, entry.description);
+      entries_.push_back(std::move(entry));
+    }
+
+    std::sort(entries_.begin(), entries_.end(),
+              [](const Entry& a, const Entry& b) {
+                if (a.group != b.group) return a.group < b.group;
+                if (a.seconds != b.seconds) return a.seconds < b.seconds;
+                return a.fingerprint < b.fingerprint;
+              });
+
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      auto& range = groups_[entries_[i].group];
+      if (range.second == 0) range.first = i;
+      range.second = i + 1;
+      exact_.try_emplace(entries_[i].fingerprint, i);
+    }
+  }
+
+  // Найти пару для строки выписки; найденная операция больше не участвует.
+  // Строка без пары запоминается как принятая.
+  MatchKind match(const Id& accountId, OperationType type, const Money& amount,
+                  const DateTime& date, const std::string& description) {
+    uint64_t group = groupKey(accountId, type, amount);
+    int64_t seconds = toSeconds(date);
+    std::string normalized = normalizeDescription(description);
+    uint64_t print = fingerprint(group, seconds, normalized);
+
+    auto range = groups_.find(group);
+    auto accepted = accepted_.find(group);
+
+    if (range != groups_.end()) {
+      auto exact = exact_.find(print);
+      if (exact != exact_.end()) {
+        for (size_t i = exact->second; i < range->second.second; ++i) {
+          Entry& entry = entries_[i];
+          if (entry.seconds != seconds) break;
+          if (!entry.used && entry.description == normalized) {
+            entry.used = true;
+            return MatchKind::EXACT_DUPLICATE;
+          }
+        }
+      }
+    }
+    if (accepted != accepted_.end() && acceptedExact_.count(print)) {
+      auto& entries = accepted->second;
+      auto [first, last] =
+          inWindow(entries.begin(), entries.end(), seconds, 0);
+      for (auto it = first; it != last; ++it) {
+        if (it->description == normalized) return MatchKind::EXACT_DUPLICATE;
+      }
+    }
+
+    int64_t window = config_.dateWindow.count();
+    Entry* best = nullptr;
+    auto consider = [&](Entry& entry) {
+      if (entry.used || !similarDescriptions(entry.description, normalized)) {
+        return;
+      }
+      if (!best || std::llabs(entry.seconds - seconds) <
+                       std::llabs(best->seconds - seconds)) {
+        best = &entry;
+      }
+    };
+    if (range != groups_.end()) {
+      auto [first, last] = inWindow(entries_.begin() + range->second.first,
+                                    entries_.begin() + range->second.second,
+                                    seconds, window);
+      std::for_each(first, last, consider);
+    }
+    if (accepted != accepted_.end()) {
+      auto& entries = accepted->second;
+      auto [first, last] =
+          inWindow(entries.begin(), entries.end(), seconds, window);
+      std::for_each(first, last, consider);
+    }
+
+    if (!best) {
+      accept(group, seconds, print, std::move(normalized));
+      return MatchKind::NEW;
+    }
+    if (!best->accepted) best->used = true;
+    return MatchKind::FUZZY_DUPLICATE;
+  }
+
+  // Нижний регистр ASCII, только буквы и цифры, пробелы схлопнуты.
+  // Байты UTF-8 вне ASCII сохраняются как есть.
+  static std::string normalizeDescription(const std::string& description) {
+    std::string result;
+    result.reserve(description.size());
+    bool pendingSpace = false;
+    for (unsigned char c : description) {
+      if (c >= 0x80 || std::isalnum(c)) {
+        if (pendingSpace && !result.empty()) result.push_back(' ');
+        pendingSpace = false;
+        result.push_back(static_cast<char>(c < 0x80 ? std::tolower(c) : c));
+      } else {
+        pendingSpace = true;
+      }
+    }
+    return result;
+  }
+
+ private:
+  // Записи отрезка [first, last), упорядоченного по времени, в окне
+  // seconds ± window
+  template <typename It>
+  static std::pair<It, It> inWindow(It first, It last, int64_t seconds,
+                                    int64_t window) {
+    first = std::lower_bound(first, last, seconds - window,
+                             [](const Entry& entry, int64_t value) {
+                               return entry.seconds < value;
+                             });
+    last = std::upper_bound(first, last, seconds + window,
+                            [](int64_t value, const Entry& entry) {
+                              return value < entry.seconds;
+                            });
+    return {first, last};
+  }
+
+  void accept(uint64_t group, int64_t seconds, uint64_t print,
+              std::string normalized) {
+    auto& entries = accepted_[group];
+    auto position = std::upper_bound(entries.begin(), entries.end(), seconds,
+                                     [](int64_t value, const Entry& entry) {
+                                       return value < entry.seconds;
+                                     });
+    Entry entry{group, seconds, print, std::move(normalized)};
+    entry.accepted = true;
+    entries.insert(position, std::move(entry));
+    acceptedExact_.insert(print);
+  }
+
+  // Банки обрезают назначение платежа, поэтому префикс тоже совпадение;
+  // пустое описание не мешает сопоставлению по остальным полям
+  static bool similarDescriptions(const std::string& a, const std::string& b) {
+    if (a.empty() || b.empty()) return true;
+    const std::string& shorter = a.size() < b.size() ? a : b;
+    const std::string& longer = a.size() < b.size() ? b : a;
+    return longer.compare(0, shorter.size(), shorter) == 0;
+  }
+
+  static int64_t toSeconds(const DateTime& date) {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               date.time_since_epoch())
+        .count();
+  }
+
+  static uint64_t mix(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+  }
+
+  static uint64_t groupKey(const Id& accountId, OperationType type,
+                           const Money& amount) {
+    uint64_t h = std::hash<std::string>{}(accountId);
+    h = mix(h, static_cast<uint64_t>(type));
+    h = mix(h, static_cast<uint64_t>(std::llround(amount.getAmount() * 100)));
+    h = mix(h, std::hash<std::string_view>{}(amount.getCurrencyCode().view()));
+    return h;
+  }
+
+  static uint64_t fingerprint(uint64_t group, int64_t seconds,
+                              const std::string& description) {
+    uint64_t h = mix(group, static_cast<uint64_t>(seconds));
+    return mix(h, std::hash<std::string>{}(description));
+  }
+};
+
+}  // namespace financial::domain
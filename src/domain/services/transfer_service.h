@@ -0,0 +1,147 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/exceptions.h"
+#include "common/types.h"
+#include "domain/entities/bank_account.h"
+#include "domain/entities/operation.h"
+#include "domain/factories/entity_factory.h"
+#include "domain/repositories/repository_interfaces.h"
+#include "domain/services/account_lock_service.h"
+
+namespace financial::domain {
+
+// Результат перевода: пара проводок, по которой перевод можно отменить
+struct TransferReceipt {
+  Id fromAccountId;
+  Id toAccountId;
+  Money amount;
+  std::shared_ptr<Operation> withdrawal;
+  std::shared_ptr<Operation> deposit;
+};
+
+// Сервис переводов между счетами.
+// Перевод захватывает блокировки обоих счетов из AccountLockService —
+// тех же, что берёт проводка операций, — поэтому переводы между
+// непересекающимися парами счетов идут параллельно.
+// Обе проводки создаются одним пакетом и сохраняются одной вставкой.
+class TransferService {
+ public:
+  static constexpr const char* TRANSFER_CATEGORY_NAME = "Перевод";
+
+ private:
+  std::shared_ptr<IBankAccountRepository> accountRepo_;
+  std::shared_ptr<ICategoryRepository> categoryRepo_;
+  std::shared_ptr<IOperationRepository> operationRepo_;
+  std::shared_ptr<IEntityFactory> entityFactory_;
+  std::shared_ptr<AccountLockService> accountLocks_;
+
+  // Категория переводов ищется по имени один раз, дальше проверяется
+  // только то, что она не удалена
+  std::mutex categoryMutex_;
+  std::optional<Id> transferCategoryId_;
+
+ public:
+  TransferService(std::shared_ptr<IBankAccountRepository> accountRepo,
+                  std::shared_ptr<ICategoryRepository> categoryRepo,
+                  std::shared_ptr<IOperationRepository> operationRepo,
+                  std::shared_ptr<IEntityFactory> entityFactory,
+                  std::shared_ptr<AccountLockService> accountLocks = nullptr)
+      : accountRepo_(accountRepo),
+        categoryRepo_(categoryRepo),
+        operationRepo_(operationRepo),
+        entityFactory_(entityFactory),
+        accountLocks_(accountLocks ? std::move(accountLocks)
+                                   : std::make_shared<AccountLockService>()) {}
+
+  TransferReceipt transfer(const Id& fromAccountId, const Id& toAccountId,
+                           const Money& amount,
+                           const std::string& description = "Перевод") {
+    if (fromAccountId == toAccountId) {
+      throw ValidationException("Cannot transfer to the same account");
+    }
+
+    // Проводки готовятся до захвата блокировок
+    Id categoryId = transferCategoryId();
+    OperationColumns legs;
+    legs.reserve(2);
+    legs.add(OperationType::EXPENSE, fromAccountId, amount, categoryId,
+             description, DateTimeUtils::now());
+    legs.add(OperationType::INCOME, toAccountId, amount, categoryId,
+             description, legs.dates.front());
+
+    auto batch = entityFactory_->createOperations(std::move(legs));
+    if (!batch.rejected.empty()) {
+      throw ValidationException(
+          std::string("Invalid transfer: ") +
+          errorCodeToString(batch.rejected.front().code));
+    }
+
+    TransferReceipt receipt{fromAccountId, toAccountId, amount,
+                            batch.created[0], batch.created[1]};
+
+    auto locks = accountLocks_->lockPair(fromAccountId, toAccountId);
+    auto [fromAccount, toAccount] = findPair(fromAccountId, toAccountId);
+
+    fromAccount->transfer(*toAccount, amount);
+
+    accountRepo_->update(fromAccount);
+    accountRepo_->update(toAccount);
+    operationRepo_->saveAll(batch.created);
+
+    return receipt;
+  }
+
+  // Отменить перевод: вернуть сумму и удалить обе проводки
+  void revert(const TransferReceipt& receipt) {
+    auto locks =
+        accountLocks_->lockPair(receipt.fromAccountId, receipt.toAccountId);
+    auto [fromAccount, toAccount] =
+        findPair(receipt.fromAccountId, receipt.toAccountId);
+
+    toAccount->transfer(*fromAccount, receipt.amount);
+
+    accountRepo_->update(fromAccount);
+    accountRepo_->update(toAccount);
+    if (receipt.withdrawal) operationRepo_->remove(receipt.withdrawal->getId());
+    if (receipt.deposit) operationRepo_->remove(receipt.deposit->getId());
+  }
+
+  Id transferCategoryId() {
+    std::lock_guard<std::mutex> lock(categoryMutex_);
+    if (transferCategoryId_ && categoryRepo_->findById(*transferCategoryId_)) {
+      return *transferCategoryId_;
+    }
+
+    auto category = categoryRepo_->findByName(TRANSFER_CATEGORY_NAME);
+    if (!category) {
+      category = entityFactory_->createCategory(
+          CategoryType::EXPENSE, TRANSFER_CATEGORY_NAME,
+          "Переводы между счетами");
+      categoryRepo_->save(*category);
+    }
+    transferCategoryId_ = (*category)->getId();
+    return *transferCategoryId_;
+  }
+
+ private:
+  std::pair<std::shared_ptr<BankAccount>, std::shared_ptr<BankAccount>>
+  findPair(const Id& fromAccountId, const Id& toAccountId) {
+    auto fromAccount = accountRepo_->findById(fromAccountId);
+    if (!fromAccount) {
+      throw EntityNotFoundException("BankAccount", fromAccountId);
+    }
+    auto toAccount = accountRepo_->findById(toAccountId);
+    if (!toAccount) {
+      throw EntityNotFoundException("BankAccount", toAccountId);
+    }
+    return {*fromAccount, *toAccount};
+  }
+};
+
+}  // namespace financial::domain
@@ -1,42 +1,47 @@
 #pragma once
 
+#include <type_traits>
+
 #include "common/types.h"
 #include "common/utils.h"
 #include "common/validation.h"
 
 namespace financial::domain {
 
-// DateRange класс для фильтрации операций по дате
-class DateRange : public ValueObject {
+// DateRange класс для фильтрации операций по дате.
+// Невиртуальный и тривиально копируемый, сравнивается напрямую.
+class DateRange {
  private:
   DateTime start_;
   DateTime end_;
 
  public:
-  DateRange() = default;
+  constexpr DateRange() = default;
 
-  DateRange(const DateTime& start, const DateTime& end)
+  constexpr DateRange(const DateTime& start, const DateTime& end)
       : start_(start), end_(end) {
     if (start > end) {
       throw ValidationException("Start date must be before end date");
     }
   }
 
-  const DateTime& getStart() const { return start_; }
-  const DateTime& getEnd() const { return end_; }
+  constexpr const DateTime& getStart() const { return start_; }
+  constexpr const DateTime& getEnd() const { return end_; }
 
-  bool contains(const DateTime& date) const {
+  constexpr bool contains(const DateTime& date) const {
     return date >= start_ && date <= end_;
   }
 
-  bool overlaps(const DateRange& other) const {
+  constexpr bool overlaps(const DateRange& other) const {
     return start_ <= other.end_ && end_ >= other.start_;
   }
 
-  bool equals(const ValueObject& other) const override {
-    auto* otherRange = dynamic_cast<const DateRange*>(&other);
-    if (!otherRange) return false;
-    return start_ == otherRange->start_ && end_ == otherRange->end_;
+  constexpr bool operator==(const DateRange& other) const {
+    return start_ == other.start_ && end_ == other.end_;
+  }
+
+  constexpr bool operator!=(const DateRange& other) const {
+    return !(*this == other);
   }
 
   static DateRange today() {
@@ -93,4 +98,6 @@ class DateRange : public ValueObject {
   }
 };
 
+static_assert(std::is_trivially_copyable_v<DateRange>);
+
 }  // namespace financial::domain
\ No newline at end of file
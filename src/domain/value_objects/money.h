@@ -1,37 +1,88 @@
 #pragma once
 
-#include <cmath>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "common/types.h"
-#include "common/validation.h"
+#include "common/exceptions.h"
 
 namespace financial::domain {
 
-// Объект денежной стоимости
-class Money : public ValueObject {
-  Decimal amount_;
-  std::string currency_;
+// Код валюты (до трёх символов), хранящийся внутри объекта без выделения
+// памяти. Сравнение — побайтовое, без обращения к std::string.
+class CurrencyCode {
+  static constexpr size_t MAX_LENGTH = 3;
+
+  char code_[MAX_LENGTH + 1] = {};
 
  public:
-  Money() = default;
+  constexpr CurrencyCode() = default;
 
-  explicit Money(Decimal amount, const std::string& currency = "RUB")
-      : amount_(amount), currency_(currency) {
-    Validator::validateNotEmpty(currency, "Currency");
-    Validator::validateMaxLength(currency, 3, "Currency");
+  constexpr explicit CurrencyCode(std::string_view code) {
+    if (code.empty()) {
+      throw ValidationException("Currency cannot be empty");
+    }
+    if (code.size() > MAX_LENGTH) {
+      throw ValidationException("Currency exceeds maximum length of 3");
+    }
+    for (size_t i = 0; i < code.size(); ++i) code_[i] = code[i];
   }
 
-  Decimal getAmount() const { return amount_; }
-  const std::string& getCurrency() const { return currency_; }
+  constexpr std::string_view view() const {
+    size_t length = 0;
+    while (length < MAX_LENGTH && code_[length] != '\0') length++;
+    return std::string_view(code_, length);
+  }
+
+  std::string toString() const { return std::string(view()); }
+
+  constexpr bool operator==(const CurrencyCode& other) const {
+    for (size_t i = 0; i < MAX_LENGTH; ++i) {
+      if (code_[i] != other.code_[i]) return false;
+    }
+    return true;
+  }
+
+  constexpr bool operator!=(const CurrencyCode& other) const {
+    return !(*this == other);
+  }
+};
+
+// Объект денежной стоимости.
+// Не имеет виртуальных методов и тривиально копируется, поэтому хранится
+// в непрерывных массивах и сравнивается без RTTI.
+class Money {
+  static constexpr Decimal EPSILON = 0.001;
+
+  Decimal amount_ = 0;
+  CurrencyCode currency_;
 
-  Money add(const Money& other) const {
+ public:
+  constexpr Money() = default;
+
+  constexpr explicit Money(Decimal amount, std::string_view currency = "RUB")
+      : amount_(amount), currency_(currency) {}
+
+  constexpr Money(Decimal amount, CurrencyCode currency)
+      : amount_(amount), currency_(currency) {}
+
+  constexpr Decimal getAmount() const { return amount_; }
+  std::string getCurrency() const { return currency_.toString(); }
+  constexpr CurrencyCode getCurrencyCode() const { return currency_; }
+
+  constexpr bool hasSameCurrency(const Money& other) const {
+    return currency_ == other.currency_;
+  }
+
+  constexpr Money add(const Money& other) const {
     if (currency_ != other.currency_) {
       throw ValidationException("Cannot add money with different currencies");
     }
     return Money(amount_ + other.amount_, currency_);
   }
 
-  Money subtract(const Money& other) const {
+  constexpr Money subtract(const Money& other) const {
     if (currency_ != other.currency_) {
       throw ValidationException(
           "Cannot subtract money with different currencies");
@@ -39,26 +90,26 @@ class Money : public ValueObject {
     return Money(amount_ - other.amount_, currency_);
   }
 
-  Money multiply(double factor) const {
+  constexpr Money multiply(double factor) const {
     return Money(amount_ * factor, currency_);
   }
 
-  bool isPositive() const { return amount_ > 0; }
-  bool isNegative() const { return amount_ < 0; }
-  bool isZero() const { return std::abs(amount_) < 0.001; }
-
-  bool equals(const ValueObject& other) const override {
-    auto* otherMoney = dynamic_cast<const Money*>(&other);
-    if (!otherMoney) return false;
-    return std::abs(amount_ - otherMoney->amount_) < 0.001 &&
-           currency_ == otherMoney->currency_;
+  constexpr bool isPositive() const { return amount_ > 0; }
+  constexpr bool isNegative() const { return amount_ < 0; }
+  constexpr bool isZero() const {
+    return amount_ < EPSILON && amount_ > -EPSILON;
   }
 
-  bool operator==(const Money& other) const { return equals(other); }
+  constexpr bool operator==(const Money& other) const {
+    Decimal diff = amount_ - other.amount_;
+    return diff < EPSILON && diff > -EPSILON && currency_ == other.currency_;
+  }
 
-  bool operator!=(const Money& other) const { return !equals(other); }
+  constexpr bool operator!=(const Money& other) const {
+    return !(*this == other);
+  }
 
-  bool operator<(const Money& other) const {
+  constexpr bool operator<(const Money& other) const {
     if (currency_ != other.currency_) {
       throw ValidationException(
           "Cannot compare money with different currencies");
@@ -66,15 +117,22 @@ class Money : public ValueObject {
     return amount_ < other.amount_;
   }
 
-  bool operator>(const Money& other) const { return other < *this; }
+  constexpr bool operator>(const Money& other) const { return other < *this; }
 
-  bool operator<=(const Money& other) const { return !(*this > other); }
+  constexpr bool operator<=(const Money& other) const {
+    return !(*this > other);
+  }
 
-  bool operator>=(const Money& other) const { return !(*this < other); }
+  constexpr bool operator>=(const Money& other) const {
+    return !(*this < other);
+  }
 
-  static Money zero(const std::string& currency = "RUB") {
+  static constexpr Money zero(std::string_view currency = "RUB") {
     return Money(0, currency);
   }
 };
 
-}  // namespace financial::domain
\ No newline at end of file
+static_assert(std::is_trivially_copyable_v<CurrencyCode>);
+static_assert(std::is_trivially_copyable_v<Money>);
+
+}  // namespace financial::domain
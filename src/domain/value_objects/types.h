@@ -1,6 +1,8 @@
 #pragma once
 
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace financial::domain {
 
@@ -17,10 +19,10 @@ inline std::string operationTypeToString(OperationType type) {
   }
 }
 
-inline OperationType stringToOperationType(const std::string& str) {
+inline OperationType stringToOperationType(std::string_view str) {
   if (str == "INCOME") return OperationType::INCOME;
   if (str == "EXPENSE") return OperationType::EXPENSE;
-  throw std::invalid_argument("Invalid operation type: " + str);
+  throw std::invalid_argument("Invalid operation type: " + std::string(str));
 }
 
 enum class CategoryType {
@@ -36,10 +38,10 @@ inline std::string categoryTypeToString(CategoryType type) {
   }
 }
 
-inline CategoryType stringToCategoryType(const std::string& str) {
+inline CategoryType stringToCategoryType(std::string_view str) {
   if (str == "INCOME") return CategoryType::INCOME;
   if (str == "EXPENSE") return CategoryType::EXPENSE;
-  throw std::invalid_argument("Invalid category type: " + str);
+  throw std::invalid_argument("Invalid category type: " + std::string(str));
 }
 
 } // namespace financial::domain
\ No newline at end of file
@@ -7,10 +7,14 @@
 #include <mutex>
 #include <stdexcept>
 #include <any>
+#include "common/thread_pool.h"
 #include "domain/repositories/repository_interfaces.h"
 #include "domain/factories/entity_factory.h"
 #include "domain/services/domain_services.h"
+#include "domain/services/forecast_service.h"
+#include "domain/services/transfer_service.h"
 #include "infrastructure/persistence/in_memory_repository.h"
+#include "infrastructure/persistence/persistent_repository.h"
 #include "infrastructure/proxy/caching_proxy.h"
 
 namespace financial::infrastructure {
@@ -138,9 +142,14 @@ public:
 
         auto unitOfWork = container.resolve<domain::IUnitOfWork>();
 
+        // Общий пул для всех параллельных задач: аналитики, сверки,
+        // проверки импорта и сжатия экспорта
+        container.registerSingleton<ThreadPool>(
+            []() { return std::make_shared<ThreadPool>(NumaTopology::system(), 0); });
+
         container.registerSingleton<domain::IBankAccountRepository>(
             [unitOfWork, useCaching]() -> std::shared_ptr<domain::IBankAccountRepository> {
-                auto repo = std::make_shared<InMemoryBankAccountRepository>();
+                auto repo = std::make_shared<PersistentBankAccountRepository>();
                 if (useCaching) {
                     return CachingProxyFactory::createCachingBankAccountRepository(
                         repo, std::chrono::seconds(60));
@@ -150,12 +159,41 @@ public:
 
         container.registerSingleton<domain::ICategoryRepository>(
             [unitOfWork]() -> std::shared_ptr<domain::ICategoryRepository> {
-                return std::make_shared<InMemoryCategoryRepository>();
+                return std::make_shared<PersistentCategoryRepository>();
             });
 
         container.registerSingleton<domain::IOperationRepository>(
             [unitOfWork]() -> std::shared_ptr<domain::IOperationRepository> {
-                return std::make_shared<InMemoryOperationRepository>();
+                // Части индекса раскладываются по узлам общего пула
+                return std::make_shared<InMemoryOperationRepository>(
+                    *DIContainer::getInstance().resolve<ThreadPool>());
+            });
+
+        container.registerSingleton<domain::AnomalyDetector>(
+            []() { return std::make_shared<domain::AnomalyDetector>(); });
+
+        container.registerSingleton<domain::BudgetService>(
+            []() {
+                return std::make_shared<domain::BudgetService>(
+                    DIContainer::getInstance()
+                        .resolve<domain::IOperationRepository>());
+            });
+
+        // Единственный экземпляр: блокировки счетов общие для всех
+        // сервисов, меняющих баланс
+        container.registerSingleton<domain::AccountLockService>(
+            []() { return std::make_shared<domain::AccountLockService>(); });
+
+        container.registerSingleton<domain::TransferService>(
+            []() {
+                auto& c = DIContainer::getInstance();
+                return std::make_shared<domain::TransferService>(
+                    c.resolve<domain::IBankAccountRepository>(),
+                    c.resolve<domain::ICategoryRepository>(),
+                    c.resolve<domain::IOperationRepository>(),
+                    c.resolve<domain::IEntityFactory>(),
+                    c.resolve<domain::AccountLockService>()
+                );
             });
 
         // Зарегистрировать доменные сервисы
@@ -164,7 +202,8 @@ public:
                 auto& c = DIContainer::getInstance();
                 return std::make_shared<domain::AnalyticsService>(
                     c.resolve<domain::IOperationRepository>(),
-                    c.resolve<domain::ICategoryRepository>()
+                    c.resolve<domain::ICategoryRepository>(),
+                    c.resolve<ThreadPool>()
                 );
             });
 
@@ -172,6 +211,17 @@ public:
             []() {
                 auto& c = DIContainer::getInstance();
                 return std::make_shared<domain::BalanceReconciliationService>(
+                    c.resolve<domain::IBankAccountRepository>(),
+                    c.resolve<domain::IOperationRepository>(),
+                    c.resolve<ThreadPool>(),
+                    c.resolve<domain::AccountLockService>()
+                );
+            });
+
+        container.registerTransient<domain::CashFlowForecastService>(
+            []() {
+                auto& c = DIContainer::getInstance();
+                return std::make_shared<domain::CashFlowForecastService>(
                     c.resolve<domain::IBankAccountRepository>(),
                     c.resolve<domain::IOperationRepository>()
                 );
@@ -183,7 +233,10 @@ public:
                 return std::make_shared<domain::OperationProcessingService>(
                     c.resolve<domain::IBankAccountRepository>(),
                     c.resolve<domain::IOperationRepository>(),
-                    c.resolve<domain::IEntityFactory>()
+                    c.resolve<domain::IEntityFactory>(),
+                    c.resolve<domain::AnomalyDetector>(),
+                    c.resolve<domain::BudgetService>(),
+                    c.resolve<domain::AccountLockService>()
                 );
             });
     }
@@ -1,71 +1,138 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "common/concurrent_hash_map.h"
+#include "common/thread_pool.h"
 #include "domain/entities/bank_account.h"
 #include "domain/entities/category.h"
 #include "domain/entities/operation.h"
 #include "domain/repositories/repository_interfaces.h"
+#include "infrastructure/persistence/persistent_repository.h"
+#include "infrastructure/persistence/tag_index.h"
 
 namespace financial::infrastructure {
 
 using namespace financial::domain;
 
-// Защищённый от многопоточных запросов репозиторий
-template <typename T>
-class InMemoryRepository : public IRepository<T> {
+// Защищённый от многопоточных запросов репозиторий на
+// ConcurrentHashMap: чтение и одиночные записи не берут mutex_.
+// Мьютекс сериализует пакетные записи (saveAll, clear) и запросы
+// наследников, которым нужно согласованное состояние своих индексов.
+// Сущности в таблице неизменяемы, как в PersistentRepository: запись
+// кладёт копию, findById отдаёт копию.
+// Interface — интерфейс репозитория сущности (наследует IRepository<T>
+// виртуально); реализация наследует его по единственному пути.
+template <typename T, typename Interface = IRepository<T>>
+class InMemoryRepository : public Interface {
  protected:
+  using Stored = std::shared_ptr<const T>;
+
+  // Сколько раз findAll пробует обойти таблицу без блокировки, прежде
+  // чем дождаться мьютекса
+  static constexpr int OPTIMISTIC_ATTEMPTS = 2;
+
+  // Снимок — копия таблицы указателей на неизменяемые сущности
+  class TableSnapshot : public IRepositorySnapshot<T> {
+   private:
+    std::unordered_map<Id, Stored> entities_;
+
+   public:
+    explicit TableSnapshot(const std::vector<std::shared_ptr<T>>& entities) {
+      entities_.reserve(entities.size());
+      for (const auto& entity : entities) {
+        entities_.emplace(entity->getId(), entity);
+      }
+    }
+
+    std::shared_ptr<const T> findById(const Id& id) const override {
+      auto it = entities_.find(id);
+      return it != entities_.end() ? it->second : nullptr;
+    }
+
+    void forEach(
+        const std::function<void(const T&)>& visitor) const override {
+      for (const auto& [id, entity] : entities_) visitor(*entity);
+    }
+
+    size_t size() const override { return entities_.size(); }
+  };
+
   mutable std::mutex mutex_;
-  std::unordered_map<Id, std::shared_ptr<T>> storage_;
+  ConcurrentHashMap<Id, Stored> storage_;
+  // Нечётное значение — идёт пакетная запись (см. BatchScope)
+  std::atomic<uint64_t> batchVersion_{0};
 
  public:
   void save(std::shared_ptr<T> entity) override {
+    storage_.insertOrAssign(entity->getId(),
+                            std::make_shared<const T>(*entity));
+  }
+
+  // Пакеты сериализуются мьютексом, а findAll не отдаёт таблицу,
+  // пока пакет пишется: читатели видят либо ни одной, либо все
+  // сущности пакета
+  void saveAll(const std::vector<std::shared_ptr<T>>& entities) override {
     std::lock_guard<std::mutex> lock(mutex_);
-    storage_[entity->getId()] = entity;
+    BatchScope batch(batchVersion_);
+    storage_.reserve(storage_.size() + entities.size());
+    for (const auto& entity : entities) {
+      storage_.insertOrAssign(entity->getId(),
+                              std::make_shared<const T>(*entity));
+    }
   }
 
   void update(std::shared_ptr<T> entity) override {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = storage_.find(entity->getId());
-    if (it == storage_.end()) {
+    if (!storage_.replace(entity->getId(),
+                          std::make_shared<const T>(*entity))) {
       throw EntityNotFoundException("Entity", entity->getId());
     }
-    storage_[entity->getId()] = entity;
   }
 
   void remove(const Id& id) override {
-    std::lock_guard<std::mutex> lock(mutex_);
     storage_.erase(id);
   }
 
   std::optional<std::shared_ptr<T>> findById(const Id& id) override {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = storage_.find(id);
-    if (it != storage_.end()) {
-      return it->second;
+    if (auto entity = storage_.find(id)) {
+      return std::make_shared<T>(**entity);
     }
     return std::nullopt;
   }
 
+  // Без блокировки, если за время обхода не шла пакетная запись;
+  // иначе — под мьютексом, чтобы не отдать пакет наполовину
   std::vector<std::shared_ptr<T>> findAll() override {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<std::shared_ptr<T>> result;
-    result.reserve(storage_.size());
+    for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; ++attempt) {
+      uint64_t version = batchVersion_.load(std::memory_order_acquire);
+      if (version % 2 != 0) break;
 
-    for (const auto& [id, entity] : storage_) {
-      result.push_back(entity);
+      collectAll(result);
+      if (batchVersion_.load(std::memory_order_acquire) == version) {
+        return result;
+      }
     }
 
+    std::lock_guard<std::mutex> lock(mutex_);
+    collectAll(result);
     return result;
   }
 
   size_t count() override {
-    std::lock_guard<std::mutex> lock(mutex_);
     return storage_.size();
   }
 
@@ -73,241 +140,513 @@ class InMemoryRepository : public IRepository<T> {
     std::lock_guard<std::mutex> lock(mutex_);
     storage_.clear();
   }
-};
 
-// BankAccount репозиторий
-class InMemoryBankAccountRepository : public InMemoryRepository<BankAccount>,
-                                      virtual public IBankAccountRepository {
- public:
-  void save(std::shared_ptr<BankAccount> entity) override {
-    InMemoryRepository<BankAccount>::save(entity);
-  }
-
-  void update(std::shared_ptr<BankAccount> entity) override {
-    InMemoryRepository<BankAccount>::update(entity);
-  }
-
-  void remove(const Id& id) override {
-    InMemoryRepository<BankAccount>::remove(id);
+  // Состав снимка — как у findAll
+  RepositorySnapshot<T> snapshot() override {
+    return std::make_shared<const TableSnapshot>(findAll());
   }
 
-  std::optional<std::shared_ptr<BankAccount>> findById(const Id& id) override {
-    return InMemoryRepository<BankAccount>::findById(id);
+  // Одиночные записи идут мимо mutex_, поэтому проверить и заменить
+  // несколько сущностей разом нельзя: восстановление не поддерживается
+  bool restore(const RepositorySnapshot<T>&, const RepositorySnapshot<T>&,
+               const std::vector<Id>&) override {
+    return false;
   }
 
-  std::vector<std::shared_ptr<BankAccount>> findAll() override {
-    return InMemoryRepository<BankAccount>::findAll();
-  }
+ protected:
+  // Версия пакетов нечётна, пока объект жив
+  class BatchScope {
+   private:
+    std::atomic<uint64_t>& version_;
+
+   public:
+    explicit BatchScope(std::atomic<uint64_t>& version) : version_(version) {
+      version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    BatchScope(const BatchScope&) = delete;
+    BatchScope& operator=(const BatchScope&) = delete;
+    ~BatchScope() { version_.fetch_add(1, std::memory_order_release); }
+  };
 
-  size_t count() override {
-    return InMemoryRepository<BankAccount>::count();
+  // Списки отдают сохранённые версии без копирования; по контракту
+  // IRepository их только читают
+  static std::shared_ptr<T> listed(const Stored& entity) {
+    return std::const_pointer_cast<T>(entity);
   }
 
-  void clear() override {
-    InMemoryRepository<BankAccount>::clear();
+  void collectAll(std::vector<std::shared_ptr<T>>& result) const {
+    result.clear();
+    result.reserve(storage_.size());
+    storage_.forEach([&result](const Id&, const Stored& entity) {
+      result.push_back(listed(entity));
+    });
   }
+};
 
+// BankAccount репозиторий
+class InMemoryBankAccountRepository
+    : public InMemoryRepository<BankAccount, IBankAccountRepository> {
+ public:
   std::vector<std::shared_ptr<BankAccount>> findActive() override {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<std::shared_ptr<BankAccount>> result;
 
-    for (const auto& [id, account] : storage_) {
+    storage_.forEach([&](const Id&, const Stored& account) {
       if (account->getIsActive()) {
-        result.push_back(account);
+        result.push_back(listed(account));
       }
-    }
+    });
 
     return result;
   }
 
   std::optional<std::shared_ptr<BankAccount>> findByAccountNumber(
       const std::string& accountNumber) override {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::optional<std::shared_ptr<BankAccount>> result;
 
-    for (const auto& [id, account] : storage_) {
-      if (account->getAccountNumber() == accountNumber) {
-        return account;
+    storage_.forEach([&](const Id&, const Stored& account) {
+      if (!result && account->getAccountNumber() == accountNumber) {
+        result = std::make_shared<BankAccount>(*account);
       }
-    }
+    });
 
-    return std::nullopt;
+    return result;
   }
 };
 
 // Category репозиторий
-class InMemoryCategoryRepository : public InMemoryRepository<Category>,
-                                   virtual public ICategoryRepository {
-
+class InMemoryCategoryRepository
+    : public InMemoryRepository<Category, ICategoryRepository> {
  public:
-  void save(std::shared_ptr<Category> entity) override {
-    InMemoryRepository<Category>::save(entity);
-  }
-
-  void update(std::shared_ptr<Category> entity) override {
-    InMemoryRepository<Category>::update(entity);
-  }
-
-  void remove(const Id& id) override {
-    InMemoryRepository<Category>::remove(id);
-  }
-
-  std::optional<std::shared_ptr<Category>> findById(const Id& id) override {
-    return InMemoryRepository<Category>::findById(id);
-  }
-
-  std::vector<std::shared_ptr<Category>> findAll() override {
-    return InMemoryRepository<Category>::findAll();
-  }
-
-  size_t count() override {
-    return InMemoryRepository<Category>::count();
-  }
-
-  void clear() override {
-    InMemoryRepository<Category>::clear();
-  }
-
   std::vector<std::shared_ptr<Category>> findByType(
       CategoryType type) override {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<std::shared_ptr<Category>> result;
 
-    for (const auto& [id, category] : storage_) {
+    storage_.forEach([&](const Id&, const Stored& category) {
       if (category->getType() == type) {
-        result.push_back(category);
+        result.push_back(listed(category));
       }
-    }
+    });
 
     return result;
   }
 
   std::optional<std::shared_ptr<Category>> findByName(
       const std::string& name) override {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::optional<std::shared_ptr<Category>> result;
 
-    for (const auto& [id, category] : storage_) {
-      if (category->getName() == name) {
-        return category;
+    storage_.forEach([&](const Id&, const Stored& category) {
+      if (!result && category->getName() == name) {
+        result = std::make_shared<Category>(*category);
       }
-    }
+    });
 
-    return std::nullopt;
+    return result;
   }
 };
 
-// Репозиторий операций
-class InMemoryOperationRepository : public InMemoryRepository<Operation>,
-                                    virtual public IOperationRepository {
- public:
+// Репозиторий операций на PersistentRepository: состав и состояние
+// операций — неизменяемая версия отображения, findById, findAll,
+// findByType, findWhere и снимки читают её без блокировок.
+// Каждой операции выдаётся 32-битный суррогатный ключ, по которому
+// строятся вторичные индексы: тегов и категорий — на сжатых битовых
+// картах, дат — упорядоченные множества (общее и по каждому счёту).
+// Индексы ведутся в хуках записи под mutex_ и держат сохранённые
+// версии операций; старые позиции операции находятся по её прежней
+// версии, которая не меняется. Ключ удалённой операции возвращается в
+// список свободных и выдаётся следующей новой, поэтому таблицы ключей
+// не растут при обновлении состава операций.
+//
+// Индексы дат по счетам разбиты на части по хешу счёта. У каждой части
+// своя блокировка, поэтому scanPartition берёт только блокировку своей
+// части и обходы разных частей идут параллельно. Писатели берут mutex_,
+// затем блокировку части; запросы под mutex_ читают части без их
+// блокировок.
+//
+// С пулом на нескольких узлах NUMA каждому узлу достаётся по части на
+// его рабочего. Часть создаётся задачей на рабочем своего узла, и её
+// таблица счетов размещается в памяти узла (first touch); узлы
+// индекса, добавленные позже, выделяет поток писателя.
+class InMemoryOperationRepository
+    : public PersistentRepository<Operation, IOperationRepository> {
+ private:
+  using DateKey = std::pair<DateTime, uint32_t>;
+  using DateIndex = std::set<DateKey>;
+  using AccountIndex = std::map<DateKey, Stored>;
+
+  struct Partition {
+    size_t node = 0;
+    mutable std::mutex mutex;
+    std::unordered_map<Id, AccountIndex> accounts;
+  };
+
+  // Сколько счетов часть вмещает без перестройки таблицы: столько
+  // корзин размещается на узле части при её создании
+  static constexpr size_t PARTITION_ACCOUNTS = 256;
+
+  std::unordered_map<Id, uint32_t> surrogates_;
+  std::vector<Stored> bySurrogate_;
+  std::vector<uint32_t> freeKeys_;
+  RoaringBitmap live_;
+  TagIndex tagIndex_;
+  DateIndex byDate_;
+  std::vector<std::unique_ptr<Partition>> byAccount_;
+  std::unordered_map<Id, RoaringBitmap> byCategory_;
 
-  void save(std::shared_ptr<Operation> entity) override {
-    InMemoryRepository<Operation>::save(entity);
+ public:
+  // По умолчанию — по одной части на аппаратный поток
+  explicit InMemoryOperationRepository(
+      size_t partitions = std::thread::hardware_concurrency()) {
+    createPartitions(std::vector<size_t>(std::max<size_t>(1, partitions), 0),
+                     nullptr);
+  }
+
+  // По части на каждого рабочего пула; на нескольких узлах NUMA части
+  // создаются рабочими своих узлов
+  explicit InMemoryOperationRepository(ThreadPool& pool) {
+    std::vector<size_t> nodes;
+    for (size_t node = 0; node < pool.nodeCount(); ++node) {
+      nodes.insert(nodes.end(), pool.nodeWorkerCount(node), node);
+    }
+    if (nodes.empty()) nodes.push_back(0);
+    createPartitions(nodes, pool.nodeCount() > 1 ? &pool : nullptr);
   }
 
-  void update(std::shared_ptr<Operation> entity) override {
-    InMemoryRepository<Operation>::update(entity);
+  std::vector<std::shared_ptr<Operation>> findByTags(
+      const TagQuery& query) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::shared_ptr<Operation>> result;
+    tagIndex_.evaluate(query, live_).forEach([&](uint32_t key) {
+      result.push_back(listed(bySurrogate_[key]));
+    });
+    return result;
   }
 
-  void remove(const Id& id) override {
-    InMemoryRepository<Operation>::remove(id);
+  std::vector<std::pair<std::string, uint64_t>> getTagCounts() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tagIndex_.tagCounts();
   }
 
-  std::optional<std::shared_ptr<Operation>> findById(const Id& id) override {
-    return InMemoryRepository<Operation>::findById(id);
+  void scan(const OperationFilter& filter,
+            const std::function<void(const Operation&)>& visitor) override {
+    // Под блокировкой собираются только подходящие операции;
+    // посетитель вызывается уже без неё
+    std::vector<Stored> matched;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      matched = selectLocked(filter);
+    }
+    for (const auto& operation : matched) visitor(*operation);
   }
 
-  std::vector<std::shared_ptr<Operation>> findAll() override {
-    return InMemoryRepository<Operation>::findAll();
+  size_t partitionCount() override {
+    return byAccount_.size();
   }
 
-  size_t count() override {
-    return InMemoryRepository<Operation>::count();
+  size_t partitionNode(size_t partition) override {
+    return partition < byAccount_.size() ? byAccount_[partition]->node : 0;
   }
 
-  void clear() override {
-    InMemoryRepository<Operation>::clear();
+  void scanPartition(
+      size_t partition, const OperationFilter& filter,
+      const std::function<void(const Operation&)>& visitor) override {
+    if (partition >= byAccount_.size()) return;
+
+    std::vector<Stored> matched;
+    {
+      std::lock_guard<std::mutex> lock(byAccount_[partition]->mutex);
+      matched = selectPartitionLocked(partition, filter);
+    }
+    for (const auto& operation : matched) visitor(*operation);
   }
 
   std::vector<std::shared_ptr<Operation>> findByAccount(
       const Id& accountId) override {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<std::shared_ptr<Operation>> result;
+    OperationFilter filter;
+    filter.accountIds.push_back(accountId);
 
-    for (const auto& [id, operation] : storage_) {
-      if (operation->getBankAccountId() == accountId) {
-        result.push_back(operation);
-      }
+    std::vector<std::shared_ptr<Operation>> result;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      result = listedAll(selectLocked(filter));
     }
-
-    // Сортируем по дате
-    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
-      return a->getDate() > b->getDate();
-    });
-
+    // Индекс счёта упорядочен по возрастанию даты, выдаём новые первыми
+    std::reverse(result.begin(), result.end());
     return result;
   }
 
   std::vector<std::shared_ptr<Operation>> findByCategory(
       const Id& categoryId) override {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<std::shared_ptr<Operation>> result;
-
-    for (const auto& [id, operation] : storage_) {
-      if (operation->getCategoryId() == categoryId) {
-        result.push_back(operation);
-      }
-    }
+    OperationFilter filter;
+    filter.categoryIds.push_back(categoryId);
 
-    return result;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return listedAll(selectLocked(filter));
   }
 
   std::vector<std::shared_ptr<Operation>> findByDateRange(
       const DateTime& start, const DateTime& end) override {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<std::shared_ptr<Operation>> result;
-    DateRange range(start, end);
+    OperationFilter filter;
+    filter.period = DateRange(start, end);
 
-    for (const auto& [id, operation] : storage_) {
-      if (operation->isInDateRange(range)) {
-        result.push_back(operation);
-      }
+    std::vector<std::shared_ptr<Operation>> result;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      result = listedAll(selectLocked(filter));
     }
-
-    // Сортируем по дате
-    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
-      return a->getDate() > b->getDate();
-    });
-
+    std::reverse(result.begin(), result.end());
     return result;
   }
 
   std::vector<std::shared_ptr<Operation>> findByType(
       OperationType type) override {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<std::shared_ptr<Operation>> result;
 
-    for (const auto& [id, operation] : storage_) {
+    forEach([&](const Stored& operation) {
       if (operation->getType() == type) {
-        result.push_back(operation);
+        result.push_back(listed(operation));
       }
-    }
+    });
 
     return result;
   }
 
   std::vector<std::shared_ptr<Operation>> findWhere(
       std::function<bool(const Operation&)> predicate) override {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<std::shared_ptr<Operation>> result;
 
-    for (const auto& [id, operation] : storage_) {
+    forEach([&](const Stored& operation) {
       if (predicate(*operation)) {
-        result.push_back(operation);
+        result.push_back(listed(operation));
+      }
+    });
+
+    return result;
+  }
+
+ protected:
+  // Новой операции достаётся свободный ключ, если он есть. Ключ
+  // освобождается только после того, как onRemovedLocked под тем же
+  // мьютексом убрал его из всех индексов, поэтому новая операция
+  // не унаследует чужих записей
+  void onStoredLocked(const Stored& entity) override {
+    auto [it, inserted] = surrogates_.try_emplace(entity->getId(), 0);
+    if (inserted) {
+      it->second = allocateKeyLocked(entity);
+    } else {
+      unlinkLocked(it->second);
+      bySurrogate_[it->second] = entity;
+    }
+    linkLocked(it->second);
+  }
+
+  void onRemovedLocked(const Id& id) override {
+    auto it = surrogates_.find(id);
+    if (it == surrogates_.end()) return;
+
+    uint32_t key = it->second;
+    unlinkLocked(key);
+    bySurrogate_[key].reset();
+    live_.remove(key);
+    surrogates_.erase(it);
+    freeKeys_.push_back(key);
+  }
+
+  void onClearedLocked() override {
+    surrogates_.clear();
+    bySurrogate_.clear();
+    freeKeys_.clear();
+    live_.clear();
+    tagIndex_.clear();
+    byDate_.clear();
+    for (auto& partition : byAccount_) {
+      std::lock_guard<std::mutex> partitionLock(partition->mutex);
+      partition->accounts.clear();
+    }
+    byCategory_.clear();
+  }
+
+ private:
+  // nodes — узел каждой части. С пулом часть создаётся задачей на
+  // рабочем своего узла, без него — в вызывающем потоке
+  void createPartitions(const std::vector<size_t>& nodes, ThreadPool* pool) {
+    byAccount_.resize(nodes.size());
+    TaskGroup group(pool);
+    for (size_t index = 0; index < nodes.size(); ++index) {
+      group.runOnNode(nodes[index], [this, index, node = nodes[index]]() {
+        auto partition = std::make_unique<Partition>();
+        partition->node = node;
+        partition->accounts.reserve(PARTITION_ACCOUNTS);
+        byAccount_[index] = std::move(partition);
+      });
+    }
+    group.wait();
+  }
+
+  static std::vector<std::shared_ptr<Operation>> listedAll(
+      const std::vector<Stored>& operations) {
+    std::vector<std::shared_ptr<Operation>> result;
+    result.reserve(operations.size());
+    for (const auto& operation : operations) {
+      result.push_back(listed(operation));
+    }
+    return result;
+  }
+
+  // Выбор пути по самому узкому условию: счёт (с периодом — диапазон
+  // в его индексе дат), затем период, затем категории. Остальные условия
+  // проверяются по битовой карте категорий, так что просматриваются
+  // только операции из выбранного индекса
+  std::vector<Stored> selectLocked(const OperationFilter& filter) const {
+    std::vector<Stored> result;
+
+    bool byCategory = !filter.categoryIds.empty();
+    RoaringBitmap categories = categoriesLocked(filter.categoryIds);
+
+    auto accept = [&](uint32_t key) {
+      if (!byCategory || categories.contains(key)) {
+        result.push_back(bySurrogate_[key]);
+      }
+    };
+
+    if (!filter.accountIds.empty()) {
+      for (const auto& accountId : uniqueIds(filter.accountIds)) {
+        const auto& accounts = byAccount_[partitionOf(accountId)]->accounts;
+        auto it = accounts.find(accountId);
+        if (it != accounts.end()) {
+          forEachInPeriod(it->second, filter.period, [&](const auto& entry) {
+            accept(entry.first.second);
+          });
+        }
       }
+    } else if (filter.period) {
+      forEachInPeriod(byDate_, filter.period,
+                      [&](const DateKey& entry) { accept(entry.second); });
+    } else if (byCategory) {
+      categories.forEach(accept);
+    } else {
+      live_.forEach(accept);
     }
+    return result;
+  }
+
+  // Часть хранилища обходится по индексам дат своих счетов под
+  // блокировкой части. Общие индексы здесь недоступны, поэтому
+  // категория берётся из самой операции
+  std::vector<Stored> selectPartitionLocked(
+      size_t partition, const OperationFilter& filter) const {
+    std::vector<Stored> result;
 
+    std::vector<Id> categories = uniqueIds(filter.categoryIds);
+    auto accept = [&](const AccountIndex::value_type& entry) {
+      const auto& operation = entry.second;
+      if (categories.empty() ||
+          std::binary_search(categories.begin(), categories.end(),
+                             operation->getCategoryId())) {
+        result.push_back(operation);
+      }
+    };
+
+    const auto& accounts = byAccount_[partition]->accounts;
+    if (!filter.accountIds.empty()) {
+      for (const auto& accountId : uniqueIds(filter.accountIds)) {
+        if (partitionOf(accountId) != partition) continue;
+        auto it = accounts.find(accountId);
+        if (it != accounts.end()) {
+          forEachInPeriod(it->second, filter.period, accept);
+        }
+      }
+    } else {
+      for (const auto& [accountId, index] : accounts) {
+        forEachInPeriod(index, filter.period, accept);
+      }
+    }
     return result;
   }
+
+  RoaringBitmap categoriesLocked(const std::vector<Id>& categoryIds) const {
+    RoaringBitmap categories;
+    for (const auto& categoryId : categoryIds) {
+      auto it = byCategory_.find(categoryId);
+      if (it != byCategory_.end()) categories |= it->second;
+    }
+    return categories;
+  }
+
+  size_t partitionOf(const Id& accountId) const {
+    return std::hash<Id>{}(accountId) % byAccount_.size();
+  }
+
+  static std::vector<Id> uniqueIds(std::vector<Id> ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+  }
+
+  // fn получает элемент индекса, упорядоченного по DateKey
+  template <typename Index, typename Fn>
+  static void forEachInPeriod(const Index& index,
+                              const std::optional<DateRange>& period, Fn fn) {
+    auto first = index.begin();
+    auto last = index.end();
+    if (period) {
+      first = index.lower_bound(DateKey{period->getStart(), 0});
+      last = index.upper_bound(DateKey{period->getEnd(), UINT32_MAX});
+    }
+    for (auto it = first; it != last; ++it) fn(*it);
+  }
+
+  uint32_t allocateKeyLocked(const Stored& entity) {
+    uint32_t key;
+    if (!freeKeys_.empty()) {
+      key = freeKeys_.back();
+      freeKeys_.pop_back();
+      bySurrogate_[key] = entity;
+    } else {
+      key = static_cast<uint32_t>(bySurrogate_.size());
+      bySurrogate_.push_back(entity);
+    }
+    live_.add(key);
+    return key;
+  }
+
+  void linkLocked(uint32_t key) {
+    const Stored& operation = bySurrogate_[key];
+    byDate_.emplace(operation->getDate(), key);
+    {
+      Partition& partition =
+          *byAccount_[partitionOf(operation->getBankAccountId())];
+      std::lock_guard<std::mutex> lock(partition.mutex);
+      partition.accounts[operation->getBankAccountId()].insert_or_assign(
+          DateKey{operation->getDate(), key}, operation);
+    }
+    byCategory_[operation->getCategoryId()].add(key);
+    tagIndex_.add(key, operation->getTags());
+  }
+
+  // Позиции берутся из версии, под которой операция проиндексирована
+  void unlinkLocked(uint32_t key) {
+    const Operation& operation = *bySurrogate_[key];
+    byDate_.erase({operation.getDate(), key});
+
+    {
+      Partition& partition =
+          *byAccount_[partitionOf(operation.getBankAccountId())];
+      std::lock_guard<std::mutex> lock(partition.mutex);
+      auto account = partition.accounts.find(operation.getBankAccountId());
+      if (account != partition.accounts.end()) {
+        account->second.erase(DateKey{operation.getDate(), key});
+        if (account->second.empty()) partition.accounts.erase(account);
+      }
+    }
+
+    auto category = byCategory_.find(operation.getCategoryId());
+    if (category != byCategory_.end()) {
+      category->second.remove(key);
+      if (category->second.empty()) byCategory_.erase(category);
+    }
+
+    tagIndex_.remove(key, operation.getTags());
+  }
 };
 
 // реализация Unit of Workа для транзакций
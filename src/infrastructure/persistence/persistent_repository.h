@@ -0,0 +1,264 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/persistent_hash_map.h"
+#include "domain/entities/bank_account.h"
+#include "domain/entities/category.h"
+#include "domain/repositories/repository_interfaces.h"
+
+namespace financial::infrastructure {
+
+using namespace financial::domain;
+
+// Репозиторий на неизменяемом хеш-отображении. Читатель берёт текущую
+// версию отображения одной атомарной загрузкой и обходит её без
+// блокировок, даже если писатели тем временем публикуют новые.
+// Писатели сериализуются мьютексом, копируют путь от корня и публикуют
+// новую версию атомарной записью; пакет saveAll — одна версия.
+// Сущности в версиях неизменяемы: save и update кладут копию
+// переданной сущности, findById отдаёт копию сохранённой. Поэтому
+// версия — согласованный снимок и состава, и состояния сущностей:
+// snapshot() просто держит корень, а restore() публикует корень,
+// в который перенесены версии сущностей из старого.
+//
+// Наследник, которому нужны свои индексы, ведёт их в хуках
+// onStoredLocked/onRemovedLocked/onClearedLocked: они вызываются под
+// mutex_ перед публикацией каждой записи.
+//
+// Interface — интерфейс репозитория сущности (наследует IRepository<T>
+// виртуально); реализация наследует его по единственному пути.
+template <typename T, typename Interface = IRepository<T>>
+class PersistentRepository : public Interface {
+ protected:
+  using Stored = std::shared_ptr<const T>;
+  using Version = PersistentHashMap<Id, Stored>;
+
+  // Снимок держит версию отображения целиком
+  class VersionSnapshot : public IRepositorySnapshot<T> {
+   private:
+    std::shared_ptr<const Version> version_;
+
+   public:
+    explicit VersionSnapshot(std::shared_ptr<const Version> version)
+        : version_(std::move(version)) {}
+
+    std::shared_ptr<const T> findById(const Id& id) const override {
+      const Stored* entity = version_->find(id);
+      return entity ? *entity : nullptr;
+    }
+
+    void forEach(
+        const std::function<void(const T&)>& visitor) const override {
+      version_->forEach(
+          [&visitor](const Id&, const Stored& entity) { visitor(*entity); });
+    }
+
+    size_t size() const override { return version_->size(); }
+
+    const Version& version() const { return *version_; }
+  };
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<const Version> root_ = std::make_shared<const Version>();
+
+ public:
+  void save(std::shared_ptr<T> entity) override {
+    Stored stored = std::make_shared<const T>(*entity);
+    std::lock_guard<std::mutex> lock(mutex_);
+    onStoredLocked(stored);
+    publish(current().insert(stored->getId(), stored));
+  }
+
+  // Пакет публикуется одной версией: читатели видят либо ни одной,
+  // либо все сущности пакета
+  void saveAll(const std::vector<std::shared_ptr<T>>& entities) override {
+    std::vector<Stored> batch;
+    batch.reserve(entities.size());
+    for (const auto& entity : entities) {
+      batch.push_back(std::make_shared<const T>(*entity));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Version next = current();
+    for (const auto& stored : batch) {
+      onStoredLocked(stored);
+      next = next.insert(stored->getId(), stored);
+    }
+    publish(std::move(next));
+  }
+
+  // Старая версия сущности не меняется: снимки, которые её держат,
+  // видят прежнее состояние
+  void update(std::shared_ptr<T> entity) override {
+    Stored stored = std::make_shared<const T>(*entity);
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Version& now = current();
+    if (!now.contains(stored->getId())) {
+      throw EntityNotFoundException("Entity", stored->getId());
+    }
+    onStoredLocked(stored);
+    publish(now.insert(stored->getId(), stored));
+  }
+
+  void remove(const Id& id) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    onRemovedLocked(id);
+    publish(current().erase(id));
+  }
+
+  std::optional<std::shared_ptr<T>> findById(const Id& id) override {
+    auto now = load();
+    if (const Stored* entity = now->find(id)) {
+      return std::make_shared<T>(**entity);
+    }
+    return std::nullopt;
+  }
+
+  std::vector<std::shared_ptr<T>> findAll() override {
+    std::vector<std::shared_ptr<T>> result;
+    forEach([&result](const Stored& entity) {
+      result.push_back(listed(entity));
+    });
+    return result;
+  }
+
+  size_t count() override { return load()->size(); }
+
+  void clear() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    onClearedLocked();
+    publish(Version{});
+  }
+
+  RepositorySnapshot<T> snapshot() override {
+    return std::make_shared<const VersionSnapshot>(load());
+  }
+
+  bool restore(const RepositorySnapshot<T>& previous,
+               const RepositorySnapshot<T>& expected,
+               const std::vector<Id>& ids) override {
+    const Version* from = versionOf(previous);
+    const Version* base = versionOf(expected);
+    if (!from || !base) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Version& now = current();
+    for (const auto& id : ids) {
+      if (!sameVersion(base->find(id), now.find(id))) return false;
+    }
+
+    Version next = now;
+    for (const auto& id : ids) {
+      if (const Stored* entity = from->find(id)) {
+        onStoredLocked(*entity);
+        next = next.insert(id, *entity);
+      } else if (next.contains(id)) {
+        onRemovedLocked(id);
+        next = next.erase(id);
+      }
+    }
+    publish(std::move(next));
+    return true;
+  }
+
+ protected:
+  // Сущность stored сохраняется (новая или новая версия прежней)
+  virtual void onStoredLocked(const Stored&) {}
+  // Сущность id удаляется; её может и не быть
+  virtual void onRemovedLocked(const Id&) {}
+  virtual void onClearedLocked() {}
+
+  std::shared_ptr<const Version> load() const {
+    return std::atomic_load(&root_);
+  }
+
+  // Обход одной версии без блокировок
+  template <typename Fn>
+  void forEach(Fn fn) const {
+    auto now = load();
+    now->forEach([&fn](const Id&, const Stored& entity) { fn(entity); });
+  }
+
+  // Вызывается под mutex_: других писателей нет
+  const Version& current() const { return *root_; }
+
+  void publish(Version next) {
+    std::atomic_store(&root_,
+                      std::shared_ptr<const Version>(
+                          std::make_shared<const Version>(std::move(next))));
+  }
+
+  // Списки отдают сохранённые версии без копирования; по контракту
+  // IRepository их только читают
+  static std::shared_ptr<T> listed(const Stored& entity) {
+    return std::const_pointer_cast<T>(entity);
+  }
+
+  // Восстанавливать можно только из снимков этой реализации
+  static const Version* versionOf(const RepositorySnapshot<T>& snapshot) {
+    const auto* versioned =
+        dynamic_cast<const VersionSnapshot*>(snapshot.get());
+    return versioned ? &versioned->version() : nullptr;
+  }
+
+  static bool sameVersion(const Stored* first, const Stored* second) {
+    return (first ? first->get() : nullptr) ==
+           (second ? second->get() : nullptr);
+  }
+};
+
+class PersistentBankAccountRepository
+    : public PersistentRepository<BankAccount, IBankAccountRepository> {
+ public:
+  std::vector<std::shared_ptr<BankAccount>> findActive() override {
+    std::vector<std::shared_ptr<BankAccount>> result;
+    forEach([&result](const Stored& account) {
+      if (account->getIsActive()) result.push_back(listed(account));
+    });
+    return result;
+  }
+
+  std::optional<std::shared_ptr<BankAccount>> findByAccountNumber(
+      const std::string& accountNumber) override {
+    std::optional<std::shared_ptr<BankAccount>> result;
+    forEach([&](const Stored& account) {
+      if (!result && account->getAccountNumber() == accountNumber) {
+        result = std::make_shared<BankAccount>(*account);
+      }
+    });
+    return result;
+  }
+};
+
+class PersistentCategoryRepository
+    : public PersistentRepository<Category, ICategoryRepository> {
+ public:
+  std::vector<std::shared_ptr<Category>> findByType(
+      CategoryType type) override {
+    std::vector<std::shared_ptr<Category>> result;
+    forEach([&](const Stored& category) {
+      if (category->getType() == type) result.push_back(listed(category));
+    });
+    return result;
+  }
+
+  std::optional<std::shared_ptr<Category>> findByName(
+      const std::string& name) override {
+    std::optional<std::shared_ptr<Category>> result;
+    forEach([&](const Stored& category) {
+      if (!result && category->getName() == name) {
+        result = std::make_shared<Category>(*category);
+      }
+    });
+    return result;
+  }
+};
+
+}  // namespace financial::infrastructure
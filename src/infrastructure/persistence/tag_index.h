@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/roaring_bitmap.h"
+#include "domain/repositories/repository_interfaces.h"
+
+namespace financial::infrastructure {
+
+// Инвертированный индекс тегов: для каждого тега — сжатая битовая карта
+// суррогатных ключей операций. Запрос по тегам сводится к пересечению,
+// объединению и разности карт без обращения к самим операциям.
+class TagIndex {
+ private:
+  std::unordered_map<std::string, RoaringBitmap> bitmaps_;
+
+ public:
+  void add(uint32_t key, const std::vector<std::string>& tags) {
+    for (const auto& tag : tags) bitmaps_[tag].add(key);
+  }
+
+  void remove(uint32_t key, const std::vector<std::string>& tags) {
+    for (const auto& tag : tags) {
+      auto it = bitmaps_.find(tag);
+      if (it == bitmaps_.end()) continue;
+      it->second.remove(key);
+      if (it->second.empty()) bitmaps_.erase(it);
+    }
+  }
+
+  // universe — ключи всех живых операций, от него отсчитывается
+  // запрос без allOf и anyOf
+  RoaringBitmap evaluate(const domain::TagQuery& query,
+                         const RoaringBitmap& universe) const {
+    RoaringBitmap result;
+    if (!query.allOf.empty()) {
+      // Пересекаем начиная с самой редкой карты
+      std::vector<const RoaringBitmap*> required;
+      for (const auto& tag : query.allOf) {
+        const RoaringBitmap* bitmap = find(tag);
+        if (!bitmap) return {};
+        required.push_back(bitmap);
+      }
+      std::sort(required.begin(), required.end(),
+                [](const RoaringBitmap* a, const RoaringBitmap* b) {
+                  return a->cardinality() < b->cardinality();
+                });
+      result = *required.front();
+      for (size_t i = 1; i < required.size() && !result.empty(); ++i) {
+        result &= *required[i];
+      }
+    }
+
+    if (!query.anyOf.empty()) {
+      RoaringBitmap any;
+      for (const auto& tag : query.anyOf) {
+        if (const RoaringBitmap* bitmap = find(tag)) any |= *bitmap;
+      }
+      result = query.allOf.empty() ? std::move(any)
+                                   : RoaringBitmap::intersect(result, any);
+    } else if (query.allOf.empty()) {
+      result = universe;
+    }
+
+    for (const auto& tag : query.noneOf) {
+      if (result.empty()) break;
+      if (const RoaringBitmap* bitmap = find(tag)) result -= *bitmap;
+    }
+    return result;
+  }
+
+  // Число операций с каждым тегом
+  std::vector<std::pair<std::string, uint64_t>> tagCounts() const {
+    std::vector<std::pair<std::string, uint64_t>> result;
+    result.reserve(bitmaps_.size());
+    for (const auto& [tag, bitmap] : bitmaps_) {
+      result.emplace_back(tag, bitmap.cardinality());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  void clear() { bitmaps_.clear(); }
+
+ private:
+  const RoaringBitmap* find(const std::string& tag) const {
+    auto it = bitmaps_.find(tag);
+    return it == bitmaps_.end() ? nullptr : &it->second;
+  }
+};
+
+}  // namespace financial::infrastructure
@@ -10,10 +10,10 @@ namespace financial::infrastructure {
 
 using namespace financial::domain;
 
-// Cache entry with expiration
+// Cache entry with expiration; cached versions are immutable
 template<typename T>
 struct CacheEntry {
-    std::shared_ptr<T> data;
+    std::shared_ptr<const T> data;
     std::chrono::steady_clock::time_point expiry;
     
     bool isExpired() const {
@@ -35,7 +35,7 @@ private:
         cache_.clear();
     }
     
-    void cacheEntity(std::shared_ptr<T> entity) const {
+    void cacheEntity(std::shared_ptr<const T> entity) const {
         std::lock_guard<std::mutex> lock(cacheMutex_);
         cache_[entity->getId()] = {
             entity,
@@ -49,14 +49,22 @@ public:
         std::chrono::seconds cacheDuration = std::chrono::seconds(60))
         : realRepository_(realRepository), cacheDuration_(cacheDuration) {}
     
+    // The caller keeps its object, so the cache stores a copy
     void save(std::shared_ptr<T> entity) override {
         realRepository_->save(entity);
-        cacheEntity(entity);
+        cacheEntity(std::make_shared<const T>(*entity));
+    }
+    
+    void saveAll(const std::vector<std::shared_ptr<T>>& entities) override {
+        realRepository_->saveAll(entities);
+        for (const auto& entity : entities) {
+            cacheEntity(std::make_shared<const T>(*entity));
+        }
     }
     
     void update(std::shared_ptr<T> entity) override {
         realRepository_->update(entity);
-        cacheEntity(entity);
+        cacheEntity(std::make_shared<const T>(*entity));
     }
     
     void remove(const Id& id) override {
@@ -72,14 +80,14 @@ public:
             std::lock_guard<std::mutex> lock(cacheMutex_);
             auto it = cache_.find(id);
             if (it != cache_.end() && !it->second.isExpired()) {
-                return it->second.data;
+                return std::make_shared<T>(*it->second.data);
             }
         }
         
-        // Cache miss - fetch from real repository
+        // Cache miss - fetch from real repository (a private copy)
         auto result = realRepository_->findById(id);
         if (result) {
-            cacheEntity(*result);
+            cacheEntity(std::make_shared<const T>(**result));
         }
         
         return result;
@@ -106,6 +114,23 @@ public:
         invalidateCache();
     }
     
+    RepositorySnapshot<T> snapshot() override {
+        return realRepository_->snapshot();
+    }
+    
+    bool restore(const RepositorySnapshot<T>& previous,
+                 const RepositorySnapshot<T>& expected,
+                 const std::vector<Id>& ids) override {
+        if (!realRepository_->restore(previous, expected, ids)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        for (const auto& id : ids) {
+            cache_.erase(id);
+        }
+        return true;
+    }
+    
     // Cache management methods
     void clearCache() {
         invalidateCache();
@@ -142,6 +167,10 @@ public:
         cacheProxy_->save(entity);
     }
     
+    void saveAll(const std::vector<std::shared_ptr<BankAccount>>& entities) override {
+        cacheProxy_->saveAll(entities);
+    }
+    
     void update(std::shared_ptr<BankAccount> entity) override {
         cacheProxy_->update(entity);
     }
@@ -166,6 +195,16 @@ public:
         cacheProxy_->clear();
     }
     
+    RepositorySnapshot<BankAccount> snapshot() override {
+        return cacheProxy_->snapshot();
+    }
+    
+    bool restore(const RepositorySnapshot<BankAccount>& previous,
+                 const RepositorySnapshot<BankAccount>& expected,
+                 const std::vector<Id>& ids) override {
+        return cacheProxy_->restore(previous, expected, ids);
+    }
+    
     // Specialized methods
     std::vector<std::shared_ptr<BankAccount>> findActive() override {
         // These methods go directly to the real repository
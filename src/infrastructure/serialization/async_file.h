@@ -0,0 +1,339 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "common/exceptions.h"
+#include "common/thread_pool.h"
+
+namespace financial::infrastructure {
+
+// Итог записи: размеры до и после преобразования (без сжатия они
+// равны) и время от начала записи до закрытия файла
+struct CompressionStats {
+  uint64_t bytesIn = 0;
+  uint64_t bytesOut = 0;
+  double seconds = 0.0;
+
+  double ratio() const {
+    return bytesIn > 0 ? static_cast<double>(bytesOut) / bytesIn : 1.0;
+  }
+
+  double megabytesPerSecond() const {
+    return seconds > 0.0 ? bytesIn / seconds / (1024.0 * 1024.0) : 0.0;
+  }
+};
+
+// Чтение файла фрагментами с упреждением: пока вызывающий разбирает
+// фрагмент, следующий уже читается задачей пула. Чтение ещё не
+// начатого фрагмента next() забирает себе и выполняет сам, поэтому
+// ожидание не зависит от свободных рабочих и безопасно внутри задачи
+// того же пула. Без пула файл читается в next() по одному фрагменту.
+class AsyncFileReader {
+ public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 1024 * 1024;
+
+ private:
+  struct State {
+    std::ifstream file;
+    size_t chunkSize = DEFAULT_CHUNK_SIZE;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool claimed = false;  // чтение фрагмента взял исполнитель
+    bool done = false;     // фрагмент прочитан
+    bool endOfFile = false;
+    std::string chunk;
+    std::exception_ptr error;
+  };
+
+  std::shared_ptr<State> state_ = std::make_shared<State>();
+  ThreadPool* pool_;
+  uint64_t bytesRead_ = 0;
+  bool finished_ = false;
+
+ public:
+  explicit AsyncFileReader(const std::string& filename,
+                           ThreadPool* pool = nullptr,
+                           size_t chunkSize = DEFAULT_CHUNK_SIZE)
+      : pool_(pool) {
+    state_->file.open(filename, std::ios::binary);
+    if (!state_->file.is_open()) {
+      throw InfrastructureException("Невозможно открыть файл: " + filename);
+    }
+    state_->chunkSize = chunkSize > 0 ? chunkSize : DEFAULT_CHUNK_SIZE;
+    scheduleRead();
+  }
+
+  AsyncFileReader(const AsyncFileReader&) = delete;
+  AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+  // Ещё не начатое упреждающее чтение отменяется
+  ~AsyncFileReader() {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->claimed = true;
+  }
+
+  // Следующий фрагмент в chunk; false — файл прочитан до конца
+  bool next(std::string& chunk) {
+    if (finished_) return false;
+    State& state = *state_;
+    if (claim(state)) readChunk(state);
+
+    bool endOfFile;
+    {
+      std::unique_lock<std::mutex> lock(state.mutex);
+      state.ready.wait(lock, [&state]() { return state.done; });
+      if (state.error) std::rethrow_exception(state.error);
+      chunk = std::move(state.chunk);
+      state.chunk.clear();
+      endOfFile = state.endOfFile;
+    }
+
+    if (endOfFile) {
+      finished_ = true;
+    } else {
+      scheduleRead();
+    }
+    bytesRead_ += chunk.size();
+    return !chunk.empty();
+  }
+
+  // Весь остаток файла одной строкой
+  std::string readAll() {
+    std::string content;
+    std::string chunk;
+    while (next(chunk)) content += chunk;
+    return content;
+  }
+
+  uint64_t bytesRead() const { return bytesRead_; }
+
+ private:
+  void scheduleRead() {
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      state_->claimed = false;
+      state_->done = false;
+    }
+    if (!pool_) return;
+    pool_->post([shared = state_]() {
+      if (claim(*shared)) readChunk(*shared);
+    });
+  }
+
+  static bool claim(State& state) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.claimed) return false;
+    state.claimed = true;
+    return true;
+  }
+
+  // Файл трогает только исполнитель, взявший фрагмент
+  static void readChunk(State& state) {
+    std::string chunk;
+    std::exception_ptr error;
+    bool endOfFile = false;
+    try {
+      chunk.resize(state.chunkSize);
+      state.file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+      chunk.resize(static_cast<size_t>(state.file.gcount()));
+      if (state.file.bad()) {
+        throw InfrastructureException("Ошибка чтения файла");
+      }
+      endOfFile = state.file.eof() || chunk.empty();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.chunk = std::move(chunk);
+    state.endOfFile = endOfFile;
+    state.error = error;
+    state.done = true;
+    state.ready.notify_all();
+  }
+};
+
+// Преобразование потока перед записью на диск (например, сжатие).
+// Вызывается строго последовательно, из одного исполнителя за раз
+class ChunkEncoder {
+ public:
+  virtual ~ChunkEncoder() = default;
+
+  // Дописать в output результат для input; last — конец потока
+  virtual void encode(std::string_view input, bool last,
+                      std::string& output) = 0;
+};
+
+// Запись файла фрагментами. write() кладёт готовый фрагмент
+// в ограниченную очередь, а преобразует и пишет на диск задача пула,
+// поэтому форматирование следующей порции идёт параллельно с записью
+// предыдущей. Запись последовательна: очередь разбирает не больше
+// одного исполнителя за раз. Если очередь заполнена, а задача пула
+// ещё не запущена (все рабочие заняты), write() пишет сам — ожидание
+// не зависит от свободных рабочих. Без пула вся запись идёт в write().
+//
+// Состояние живёт в разделяемом объекте: задача, поставленная в пул,
+// держит его сама и безопасна даже после разрушения писателя.
+class AsyncFileWriter {
+ private:
+  static constexpr size_t MAX_QUEUED_CHUNKS = 8;
+
+  struct State {
+    std::ofstream file;
+    std::unique_ptr<ChunkEncoder> encoder;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::string> queue;
+    bool scheduled = false;  // задача разбора поставлена в пул
+    bool draining = false;   // кто-то сейчас пишет
+    bool finished = false;
+    std::exception_ptr error;
+    CompressionStats stats;
+  };
+
+  std::shared_ptr<State> state_ = std::make_shared<State>();
+  ThreadPool* pool_;
+  std::chrono::steady_clock::time_point start_;
+
+ public:
+  // encoder == nullptr — фрагменты пишутся как есть
+  explicit AsyncFileWriter(const std::string& filename,
+                           ThreadPool* pool = nullptr,
+                           std::unique_ptr<ChunkEncoder> encoder = nullptr)
+      : pool_(pool), start_(std::chrono::steady_clock::now()) {
+    state_->encoder = std::move(encoder);
+    state_->file.open(filename, std::ios::binary);
+    if (!state_->file.is_open()) {
+      throw InfrastructureException("Невозможно создать файл: " + filename);
+    }
+  }
+
+  AsyncFileWriter(const AsyncFileWriter&) = delete;
+  AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+  virtual ~AsyncFileWriter() = default;
+
+  void write(std::string chunk) {
+    if (chunk.empty()) return;
+    State& state = *state_;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    if (state.error) std::rethrow_exception(state.error);
+    state.queue.push_back(std::move(chunk));
+
+    if (pool_ && !state.draining && !state.scheduled) {
+      state.scheduled = true;
+      pool_->post([shared = state_]() { drainFromPool(*shared); });
+    }
+
+    size_t limit = pool_ ? MAX_QUEUED_CHUNKS : 0;
+    while (state.queue.size() > limit && !state.error) {
+      if (state.draining) {
+        state.changed.wait(lock);
+        continue;
+      }
+      state.draining = true;
+      lock.unlock();
+      drain(state);
+      lock.lock();
+    }
+    if (state.error) std::rethrow_exception(state.error);
+  }
+
+  // Дождаться записи всех фрагментов и закрыть файл
+  CompressionStats finish() {
+    State& state = *state_;
+    {
+      std::unique_lock<std::mutex> lock(state.mutex);
+      state.changed.wait(lock, [&state]() { return !state.draining; });
+      if (state.error) std::rethrow_exception(state.error);
+      state.draining = true;
+      state.finished = true;
+    }
+    drain(state);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.error) std::rethrow_exception(state.error);
+    closeFile(state);
+    state.stats.seconds = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start_)
+                              .count();
+    return state.stats;
+  }
+
+ private:
+  static void drainFromPool(State& state) {
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.scheduled = false;
+      // Очередь уже разбирает писатель или файл закрыт
+      if (state.draining || state.finished) return;
+      state.draining = true;
+    }
+    drain(state);
+  }
+
+  // Вызывающий выставил draining и пишет очередь, пока она не опустеет
+  static void drain(State& state) {
+    std::string chunk;
+    try {
+      while (true) {
+        {
+          std::lock_guard<std::mutex> lock(state.mutex);
+          if (state.queue.empty()) {
+            state.draining = false;
+            state.changed.notify_all();
+            return;
+          }
+          chunk = std::move(state.queue.front());
+          state.queue.pop_front();
+          state.changed.notify_all();
+        }
+        state.stats.bytesIn += chunk.size();
+        writeChunk(state, chunk, false);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.error = std::current_exception();
+      state.queue.clear();
+      state.draining = false;
+      state.changed.notify_all();
+    }
+  }
+
+  static void writeChunk(State& state, std::string_view chunk, bool last) {
+    if (!state.encoder) {
+      writeBytes(state, chunk);
+      return;
+    }
+    std::string encoded;
+    state.encoder->encode(chunk, last, encoded);
+    writeBytes(state, encoded);
+  }
+
+  static void writeBytes(State& state, std::string_view bytes) {
+    state.file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    state.stats.bytesOut += bytes.size();
+    if (!state.file) {
+      throw InfrastructureException("Ошибка записи файла");
+    }
+  }
+
+  static void closeFile(State& state) {
+    writeChunk(state, {}, true);
+    state.file.close();
+    if (state.file.fail()) {
+      throw InfrastructureException("Ошибка записи файла");
+    }
+  }
+};
+
+}  // namespace financial::infrastructure
@@ -0,0 +1,515 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/exceptions.h"
+
+namespace financial::infrastructure::columnar {
+
+// Колоночный формат операций (по мотивам Parquet).
+//
+// Файл: "FCOL" + версия, затем группы строк, затем оглавление.
+// Группа строк — число строк и по странице на каждый столбец; страница —
+// номер столбца, кодировка, длина и данные. Строковые столбцы с частыми
+// повторами (счёт, категория, валюта, тип) кодируются словарём, даты —
+// разностями соседних значений, суммы хранятся как double.
+// Оглавление в конце хранит смещение и min/max даты и суммы каждой
+// группы, поэтому читатель пропускает группы вне нужного периода,
+// не декодируя их.
+//
+// Числа фиксированной ширины записываются в порядке байт little-endian,
+// переменной — как varint (знаковые — через zigzag).
+
+inline constexpr char MAGIC[4] = {'F', 'C', 'O', 'L'};
+inline constexpr uint32_t VERSION = 1;
+
+enum class Column : uint8_t {
+  ID,
+  TYPE,
+  ACCOUNT,
+  AMOUNT,
+  CURRENCY,
+  DATE,
+  CATEGORY,
+  DESCRIPTION
+};
+
+enum class Encoding : uint8_t { PLAIN, DICTIONARY, DELTA, PLAIN_DOUBLE };
+
+// Статистика группы строк из оглавления; даты — секунды от эпохи
+struct RowGroupStats {
+  uint64_t offset = 0;
+  uint32_t rows = 0;
+  int64_t minDate = 0;
+  int64_t maxDate = 0;
+  double minAmount = 0.0;
+  double maxAmount = 0.0;
+};
+
+// Строки одной группы в колоночном виде
+struct OperationRows {
+  std::vector<std::string> ids;
+  std::vector<std::string> types;
+  std::vector<std::string> accountIds;
+  std::vector<double> amounts;
+  std::vector<std::string> currencies;
+  std::vector<int64_t> dates;
+  std::vector<std::string> categoryIds;
+  std::vector<std::string> descriptions;
+
+  size_t size() const { return ids.size(); }
+
+  void clear() {
+    ids.clear();
+    types.clear();
+    accountIds.clear();
+    amounts.clear();
+    currencies.clear();
+    dates.clear();
+    categoryIds.clear();
+    descriptions.clear();
+  }
+};
+
+class ByteWriter {
+ private:
+  std::string& out_;
+
+ public:
+  explicit ByteWriter(std::string& out) : out_(out) {}
+
+  void varint(uint64_t value) {
+    while (value >= 0x80) {
+      out_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    out_.push_back(static_cast<char>(value));
+  }
+
+  void signedVarint(int64_t value) {
+    varint((static_cast<uint64_t>(value) << 1) ^
+           static_cast<uint64_t>(value >> 63));
+  }
+
+  template <typename T>
+  void fixed(T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out_.append(bytes, sizeof(T));
+  }
+
+  void string(std::string_view value) {
+    varint(value.size());
+    out_.append(value.data(), value.size());
+  }
+
+  void raw(std::string_view bytes) { out_.append(bytes.data(), bytes.size()); }
+};
+
+class ByteReader {
+ private:
+  std::string_view data_;
+  size_t pos_ = 0;
+
+ public:
+  explicit ByteReader(std::string_view data, size_t pos = 0)
+      : data_(data), pos_(pos) {}
+
+  size_t position() const { return pos_; }
+  bool atEnd() const { return pos_ >= data_.size(); }
+  size_t remaining() const { return atEnd() ? 0 : data_.size() - pos_; }
+
+  // Объявленное в файле число элементов, каждый из которых занимает не
+  // меньше minBytes байт: проверяется до выделения памяти под них
+  size_t count(size_t limit, size_t minBytes = 1) {
+    uint64_t value = varint();
+    if (value > limit || value > remaining() / minBytes) {
+      throw InfrastructureException("Колоночный файл повреждён");
+    }
+    return static_cast<size_t>(value);
+  }
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte = static_cast<uint8_t>(take(1)[0]);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) return value;
+    }
+    throw InfrastructureException("Колоночный файл: неверный varint");
+  }
+
+  int64_t signedVarint() {
+    uint64_t value = varint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  template <typename T>
+  T fixed() {
+    T value;
+    std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  std::string_view string() { return take(varint()); }
+
+  std::string_view take(size_t length) {
+    if (length > remaining()) {
+      throw InfrastructureException("Колоночный файл повреждён");
+    }
+    std::string_view result = data_.substr(pos_, length);
+    pos_ += length;
+    return result;
+  }
+};
+
+// Кодирование групп строк. Закрытые группы можно забирать по мере
+// готовности (takeReady), остаток и оглавление — в конце (finish)
+class ColumnarWriter {
+ public:
+  static constexpr size_t DEFAULT_ROW_GROUP_SIZE = 64 * 1024;
+
+ private:
+  size_t rowGroupSize_;
+  OperationRows rows_;
+  std::string ready_;
+  std::vector<RowGroupStats> groups_;
+  uint64_t written_ = 0;  // байт отдано через takeReady
+  bool headerWritten_ = false;
+
+ public:
+  explicit ColumnarWriter(size_t rowGroupSize = DEFAULT_ROW_GROUP_SIZE)
+      : rowGroupSize_(std::max<size_t>(1, rowGroupSize)) {}
+
+  void add(std::string id, std::string type, std::string accountId,
+           double amount, std::string currency, int64_t date,
+           std::string categoryId, std::string description) {
+    rows_.ids.push_back(std::move(id));
+    rows_.types.push_back(std::move(type));
+    rows_.accountIds.push_back(std::move(accountId));
+    rows_.amounts.push_back(amount);
+    rows_.currencies.push_back(std::move(currency));
+    rows_.dates.push_back(date);
+    rows_.categoryIds.push_back(std::move(categoryId));
+    rows_.descriptions.push_back(std::move(description));
+    if (rows_.size() >= rowGroupSize_) flushGroup();
+  }
+
+  void takeReady(std::string& out) {
+    writeHeader();
+    written_ += ready_.size();
+    out += ready_;
+    ready_.clear();
+  }
+
+  void finish(std::string& out) {
+    if (rows_.size() > 0) flushGroup();
+    writeHeader();
+
+    ByteWriter writer(ready_);
+    uint64_t footerOffset = written_ + ready_.size();
+    for (const auto& group : groups_) {
+      writer.fixed(group.offset);
+      writer.fixed(group.rows);
+      writer.fixed(group.minDate);
+      writer.fixed(group.maxDate);
+      writer.fixed(group.minAmount);
+      writer.fixed(group.maxAmount);
+    }
+    writer.fixed(static_cast<uint32_t>(groups_.size()));
+    writer.fixed(footerOffset);
+    writer.raw(std::string_view(MAGIC, sizeof(MAGIC)));
+    takeReady(out);
+  }
+
+  void reset() { *this = ColumnarWriter(rowGroupSize_); }
+
+ private:
+  void writeHeader() {
+    if (headerWritten_) return;
+    headerWritten_ = true;
+    std::string header;
+    ByteWriter writer(header);
+    writer.raw(std::string_view(MAGIC, sizeof(MAGIC)));
+    writer.fixed(VERSION);
+    ready_.insert(0, header);
+  }
+
+  void flushGroup() {
+    writeHeader();
+    RowGroupStats stats;
+    stats.offset = written_ + ready_.size();
+    stats.rows = static_cast<uint32_t>(rows_.size());
+    auto [minDate, maxDate] =
+        std::minmax_element(rows_.dates.begin(), rows_.dates.end());
+    auto [minAmount, maxAmount] =
+        std::minmax_element(rows_.amounts.begin(), rows_.amounts.end());
+    stats.minDate = *minDate;
+    stats.maxDate = *maxDate;
+    stats.minAmount = *minAmount;
+    stats.maxAmount = *maxAmount;
+
+    ByteWriter writer(ready_);
+    writer.varint(rows_.size());
+    writeStrings(writer, Column::ID, rows_.ids);
+    writeStrings(writer, Column::TYPE, rows_.types);
+    writeStrings(writer, Column::ACCOUNT, rows_.accountIds);
+    writeAmounts(writer, rows_.amounts);
+    writeStrings(writer, Column::CURRENCY, rows_.currencies);
+    writeDates(writer, rows_.dates);
+    writeStrings(writer, Column::CATEGORY, rows_.categoryIds);
+    writeStrings(writer, Column::DESCRIPTION, rows_.descriptions);
+
+    groups_.push_back(stats);
+    rows_.clear();
+  }
+
+  static void writePage(ByteWriter& writer, Column column, Encoding encoding,
+                        const std::string& payload) {
+    writer.fixed(static_cast<uint8_t>(column));
+    writer.fixed(static_cast<uint8_t>(encoding));
+    writer.string(payload);
+  }
+
+  // Словарь выбирается, когда различных значений не больше половины
+  static void writeStrings(ByteWriter& writer, Column column,
+                           const std::vector<std::string>& values) {
+    std::unordered_map<std::string_view, uint32_t> dictionary;
+    std::vector<std::string_view> entries;
+    std::vector<uint32_t> indices;
+    indices.reserve(values.size());
+    size_t limit = values.size() / 2;
+    for (const auto& value : values) {
+      auto [it, inserted] = dictionary.try_emplace(
+          value, static_cast<uint32_t>(entries.size()));
+      if (inserted) {
+        entries.push_back(value);
+        if (entries.size() > limit) break;
+      }
+      indices.push_back(it->second);
+    }
+
+    std::string payload;
+    ByteWriter page(payload);
+    if (entries.size() <= limit) {
+      page.varint(entries.size());
+      for (auto entry : entries) page.string(entry);
+      for (uint32_t index : indices) page.varint(index);
+      writePage(writer, column, Encoding::DICTIONARY, payload);
+    } else {
+      for (const auto& value : values) page.string(value);
+      writePage(writer, column, Encoding::PLAIN, payload);
+    }
+  }
+
+  static void writeDates(ByteWriter& writer,
+                         const std::vector<int64_t>& dates) {
+    std::string payload;
+    ByteWriter page(payload);
+    int64_t previous = 0;
+    for (int64_t date : dates) {
+      page.signedVarint(date - previous);
+      previous = date;
+    }
+    writePage(writer, Column::DATE, Encoding::DELTA, payload);
+  }
+
+  static void writeAmounts(ByteWriter& writer,
+                           const std::vector<double>& amounts) {
+    std::string payload;
+    ByteWriter page(payload);
+    for (double amount : amounts) page.fixed(amount);
+    writePage(writer, Column::AMOUNT, Encoding::PLAIN_DOUBLE, payload);
+  }
+};
+
+// Чтение колоночного файла с отсечением групп по периоду
+class ColumnarReader {
+ private:
+  std::string content_;
+  std::vector<RowGroupStats> groups_;
+  size_t groupsRead_ = 0;
+  size_t groupsSkipped_ = 0;
+
+ public:
+  explicit ColumnarReader(std::string content) : content_(std::move(content)) {
+    static constexpr size_t TRAILER = sizeof(uint32_t) + sizeof(uint64_t) +
+                                      sizeof(MAGIC);
+    if (!isColumnar(content_) || content_.size() < 8 + TRAILER ||
+        std::memcmp(content_.data() + content_.size() - sizeof(MAGIC), MAGIC,
+                    sizeof(MAGIC)) != 0) {
+      throw InfrastructureException("Файл не в колоночном формате");
+    }
+
+    ByteReader header(content_, sizeof(MAGIC));
+    if (header.fixed<uint32_t>() != VERSION) {
+      throw InfrastructureException("Неподдерживаемая версия колоночного файла");
+    }
+
+    ByteReader trailer(content_, content_.size() - TRAILER);
+    uint32_t count = trailer.fixed<uint32_t>();
+    uint64_t footerOffset = trailer.fixed<uint64_t>();
+    if (footerOffset > content_.size() - TRAILER) {
+      throw InfrastructureException("Колоночный файл повреждён");
+    }
+
+    // Запись оглавления: смещение, строки, диапазоны дат и сумм
+    static constexpr size_t FOOTER_ENTRY = sizeof(uint64_t) + sizeof(uint32_t) +
+                                           2 * sizeof(int64_t) +
+                                           2 * sizeof(double);
+    ByteReader footer(content_, footerOffset);
+    if (count > (content_.size() - TRAILER - footerOffset) / FOOTER_ENTRY) {
+      throw InfrastructureException("Колоночный файл повреждён");
+    }
+    groups_.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      RowGroupStats stats;
+      stats.offset = footer.fixed<uint64_t>();
+      if (stats.offset >= footerOffset) {
+        throw InfrastructureException("Колоночный файл повреждён");
+      }
+      stats.rows = footer.fixed<uint32_t>();
+      stats.minDate = footer.fixed<int64_t>();
+      stats.maxDate = footer.fixed<int64_t>();
+      stats.minAmount = footer.fixed<double>();
+      stats.maxAmount = footer.fixed<double>();
+      groups_.push_back(stats);
+    }
+  }
+
+  static bool isColumnar(std::string_view content) {
+    return content.size() >= sizeof(MAGIC) &&
+           std::memcmp(content.data(), MAGIC, sizeof(MAGIC)) == 0;
+  }
+
+  const std::vector<RowGroupStats>& rowGroups() const { return groups_; }
+
+  size_t rowCount() const {
+    size_t total = 0;
+    for (const auto& group : groups_) total += group.rows;
+    return total;
+  }
+
+  // Сколько групп декодировано и пропущено по статистике при последнем scan
+  size_t groupsRead() const { return groupsRead_; }
+  size_t groupsSkipped() const { return groupsSkipped_; }
+
+  // Вызвать fn(rows, i) для каждой строки с датой в [from, to]
+  // (секунды; без периода — для всех строк). Группы, чей диапазон
+  // дат не пересекается с периодом, не читаются
+  template <typename Fn>
+  void scan(std::optional<std::pair<int64_t, int64_t>> period, Fn fn) {
+    groupsRead_ = 0;
+    groupsSkipped_ = 0;
+    OperationRows rows;
+    for (const auto& group : groups_) {
+      if (period && (group.maxDate < period->first ||
+                     group.minDate > period->second)) {
+        groupsSkipped_++;
+        continue;
+      }
+      groupsRead_++;
+      decodeGroup(group, rows);
+      for (size_t i = 0; i < rows.size(); ++i) {
+        if (!period || (rows.dates[i] >= period->first &&
+                        rows.dates[i] <= period->second)) {
+          fn(static_cast<const OperationRows&>(rows), i);
+        }
+      }
+    }
+  }
+
+ private:
+  void decodeGroup(const RowGroupStats& group, OperationRows& rows) const {
+    rows.clear();
+    ByteReader reader(content_, group.offset);
+    size_t count = reader.count(group.rows);
+    if (count != group.rows) {
+      throw InfrastructureException("Колоночный файл повреждён");
+    }
+
+    for (int page = 0; page < 8; ++page) {
+      auto column = static_cast<Column>(reader.fixed<uint8_t>());
+      auto encoding = static_cast<Encoding>(reader.fixed<uint8_t>());
+      ByteReader payload(reader.string());
+      switch (column) {
+        case Column::ID: readStrings(payload, encoding, count, rows.ids); break;
+        case Column::TYPE:
+          readStrings(payload, encoding, count, rows.types);
+          break;
+        case Column::ACCOUNT:
+          readStrings(payload, encoding, count, rows.accountIds);
+          break;
+        case Column::CURRENCY:
+          readStrings(payload, encoding, count, rows.currencies);
+          break;
+        case Column::CATEGORY:
+          readStrings(payload, encoding, count, rows.categoryIds);
+          break;
+        case Column::DESCRIPTION:
+          readStrings(payload, encoding, count, rows.descriptions);
+          break;
+        case Column::AMOUNT:
+          if (count > payload.remaining() / sizeof(double)) {
+            throw InfrastructureException("Колоночный файл повреждён");
+          }
+          rows.amounts.reserve(count);
+          for (size_t i = 0; i < count; ++i) {
+            rows.amounts.push_back(payload.fixed<double>());
+          }
+          break;
+        case Column::DATE: {
+          if (count > payload.remaining()) {
+            throw InfrastructureException("Колоночный файл повреждён");
+          }
+          rows.dates.reserve(count);
+          int64_t value = 0;
+          for (size_t i = 0; i < count; ++i) {
+            value += payload.signedVarint();
+            rows.dates.push_back(value);
+          }
+          break;
+        }
+        default:
+          throw InfrastructureException("Колоночный файл: неизвестный столбец");
+      }
+    }
+  }
+
+  // Каждая строка и каждый индекс словаря занимают хотя бы байт, поэтому
+  // число элементов не может превышать остаток страницы
+  static void readStrings(ByteReader& payload, Encoding encoding, size_t count,
+                          std::vector<std::string>& out) {
+    if (count > payload.remaining()) {
+      throw InfrastructureException("Колоночный файл повреждён");
+    }
+    out.reserve(count);
+    if (encoding == Encoding::PLAIN) {
+      for (size_t i = 0; i < count; ++i) out.emplace_back(payload.string());
+      return;
+    }
+    if (encoding != Encoding::DICTIONARY) {
+      throw InfrastructureException("Колоночный файл: неверная кодировка");
+    }
+    // Словарь — различные значения группы: не больше строк в ней
+    std::vector<std::string_view> dictionary(payload.count(count));
+    for (auto& entry : dictionary) entry = payload.string();
+    for (size_t i = 0; i < count; ++i) {
+      uint64_t index = payload.varint();
+      if (index >= dictionary.size()) {
+        throw InfrastructureException("Колоночный файл повреждён");
+      }
+      out.emplace_back(dictionary[index]);
+    }
+  }
+};
+
+}  // namespace financial::infrastructure::columnar
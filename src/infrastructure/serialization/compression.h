@@ -0,0 +1,204 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "common/exceptions.h"
+#include "infrastructure/serialization/async_file.h"
+
+#ifdef FINANCIAL_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace financial::infrastructure {
+
+class Gzip {
+ public:
+  // Уровни сжатия zlib: 1 — быстрее всего, 9 — плотнее всего
+  static constexpr int MIN_LEVEL = 1;
+  static constexpr int MAX_LEVEL = 9;
+  static constexpr int DEFAULT_LEVEL = 6;
+
+  static bool isValidLevel(int level) {
+    return level >= MIN_LEVEL && level <= MAX_LEVEL;
+  }
+
+  static bool isAvailable() {
+#ifdef FINANCIAL_HAS_ZLIB
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static bool hasExtension(std::string_view filename) {
+    static constexpr std::string_view EXTENSION = ".gz";
+    return filename.size() > EXTENSION.size() &&
+           filename.substr(filename.size() - EXTENSION.size()) == EXTENSION;
+  }
+
+  // Сигнатура gzip-потока (RFC 1952)
+  static bool isCompressed(std::string_view data) {
+    return data.size() >= 2 && static_cast<unsigned char>(data[0]) == 0x1f &&
+           static_cast<unsigned char>(data[1]) == 0x8b;
+  }
+
+  static std::string decompress(std::string_view data);
+
+ private:
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  friend class GzipInflater;
+  friend class GzipEncoder;
+};
+
+// Потоковая распаковка: фрагменты сжатого файла подаются по мере
+// чтения, поэтому распаковка идёт параллельно с упреждающим чтением
+// следующего фрагмента
+class GzipInflater {
+ private:
+#ifdef FINANCIAL_HAS_ZLIB
+  z_stream stream_{};
+  bool memberEnded_ = false;
+#endif
+
+ public:
+  GzipInflater() {
+#ifdef FINANCIAL_HAS_ZLIB
+    // 15 + 32: окно 32 КБ, заголовок gzip или zlib определяется сам
+    if (inflateInit2(&stream_, 15 + 32) != Z_OK) {
+      throw InfrastructureException("Не удалось инициализировать zlib");
+    }
+#else
+    throw InfrastructureException("Сборка без zlib: сжатые файлы не поддерживаются");
+#endif
+  }
+
+  GzipInflater(const GzipInflater&) = delete;
+  GzipInflater& operator=(const GzipInflater&) = delete;
+
+  ~GzipInflater() {
+#ifdef FINANCIAL_HAS_ZLIB
+    inflateEnd(&stream_);
+#endif
+  }
+
+  // Дописать в output распакованное содержимое input
+  void feed(std::string_view input, std::string& output) {
+#ifdef FINANCIAL_HAS_ZLIB
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream_.avail_in = static_cast<uInt>(input.size());
+    char buffer[Gzip::CHUNK_SIZE];
+    while (stream_.avail_in > 0) {
+      // Склеенные gzip-члены (cat a.gz b.gz) читаются подряд
+      if (memberEnded_) {
+        inflateReset(&stream_);
+        memberEnded_ = false;
+      }
+      do {
+        stream_.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream_.avail_out = sizeof(buffer);
+        int status = inflate(&stream_, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+          throw InfrastructureException("Повреждённый gzip-поток");
+        }
+        output.append(buffer, sizeof(buffer) - stream_.avail_out);
+        if (status == Z_STREAM_END) {
+          memberEnded_ = true;
+          break;
+        }
+      } while (stream_.avail_out == 0);
+    }
+#else
+    (void)input;
+    (void)output;
+#endif
+  }
+
+  // Поток закончился на границе gzip-члена
+  void finish() const {
+#ifdef FINANCIAL_HAS_ZLIB
+    if (!memberEnded_) {
+      throw InfrastructureException("Повреждённый gzip-поток");
+    }
+#endif
+  }
+};
+
+inline std::string Gzip::decompress(std::string_view data) {
+  GzipInflater inflater;
+  std::string result;
+  result.reserve(data.size() * 4);
+  inflater.feed(data, result);
+  inflater.finish();
+  return result;
+}
+
+// Сжатие gzip для AsyncFileWriter
+class GzipEncoder : public ChunkEncoder {
+ private:
+#ifdef FINANCIAL_HAS_ZLIB
+  z_stream stream_{};
+  bool streamOpen_ = false;
+#endif
+
+ public:
+  explicit GzipEncoder(int level = Gzip::DEFAULT_LEVEL) {
+#ifdef FINANCIAL_HAS_ZLIB
+    // 15 + 16: окно 32 КБ и заголовок gzip вместо zlib
+    if (deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw InfrastructureException("Не удалось инициализировать zlib");
+    }
+    streamOpen_ = true;
+#else
+    (void)level;
+    throw InfrastructureException("Сборка без zlib: сжатый экспорт недоступен");
+#endif
+  }
+
+  GzipEncoder(const GzipEncoder&) = delete;
+  GzipEncoder& operator=(const GzipEncoder&) = delete;
+
+  ~GzipEncoder() override {
+#ifdef FINANCIAL_HAS_ZLIB
+    if (streamOpen_) deflateEnd(&stream_);
+#endif
+  }
+
+  void encode(std::string_view input, bool last,
+              std::string& output) override {
+#ifdef FINANCIAL_HAS_ZLIB
+    char buffer[Gzip::CHUNK_SIZE];
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream_.avail_in = static_cast<uInt>(input.size());
+    do {
+      stream_.next_out = reinterpret_cast<Bytef*>(buffer);
+      stream_.avail_out = sizeof(buffer);
+      deflate(&stream_, last ? Z_FINISH : Z_NO_FLUSH);
+      output.append(buffer, sizeof(buffer) - stream_.avail_out);
+    } while (stream_.avail_out == 0);
+    if (last) {
+      deflateEnd(&stream_);
+      streamOpen_ = false;
+    }
+#else
+    (void)input;
+    (void)last;
+    (void)output;
+#endif
+  }
+};
+
+// Потоковая запись gzip-файла: сжатие идёт задачей пула параллельно
+// с форматированием следующей порции (см. AsyncFileWriter)
+class GzipFileWriter : public AsyncFileWriter {
+ public:
+  explicit GzipFileWriter(const std::string& filename,
+                          ThreadPool* pool = nullptr,
+                          int level = Gzip::DEFAULT_LEVEL)
+      : AsyncFileWriter(filename, pool, std::make_unique<GzipEncoder>(level)) {}
+};
+
+}  // namespace financial::infrastructure
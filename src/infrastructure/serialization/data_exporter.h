@@ -1,13 +1,18 @@
 #pragma once
 
 #include <fstream>
+#include <functional>
+#include <future>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "domain/entities/bank_account.h"
 #include "domain/entities/category.h"
 #include "domain/entities/operation.h"
+#include "infrastructure/serialization/columnar_format.h"
+#include "infrastructure/serialization/compression.h"
 
 namespace financial::infrastructure {
 
@@ -28,6 +33,13 @@ class IExportVisitor {
 
   virtual std::string getResult() const = 0;
   virtual void reset() = 0;
+
+  // Потоковый вывод: takeReady дописывает в out уже готовую часть
+  // результата, takeRest — всё оставшееся. После них getResult()
+  // не используется до reset(). По умолчанию результат отдаётся
+  // целиком в конце
+  virtual void takeReady(std::string& out) { (void)out; }
+  virtual void takeRest(std::string& out) { out += getResult(); }
 };
 
 // Интерфейс элемента для посещаемых объектов
@@ -83,6 +95,7 @@ private:
     bool firstAccount_ = true;
     bool firstCategory_ = true;
     bool firstOperation_ = true;
+    bool bomWritten_ = false;
 
 public:
     void visit(const BankAccount& account) override {
@@ -166,6 +179,22 @@ public:
         firstAccount_ = true;
         firstCategory_ = true;
         firstOperation_ = true;
+        bomWritten_ = false;
+    }
+
+    // Строки CSV окончательны сразу после посещения
+    void takeReady(std::string& out) override {
+        if (!bomWritten_) {
+            out += "\xEF\xBB\xBF";
+            bomWritten_ = true;
+        }
+        out += buffer_.str();
+        buffer_.str("");
+        buffer_.clear();
+    }
+
+    void takeRest(std::string& out) override {
+        takeReady(out);
     }
 };
 
@@ -176,6 +205,14 @@ class JSONExportVisitor : public IExportVisitor {
   std::vector<std::string> categories_;
   std::vector<std::string> operations_;
 
+  // Состояние потокового вывода: текущий раздел и сколько его
+  // элементов уже отдано. Разделы идут в порядке посещения
+  static constexpr const char* SECTION_NAMES[] = {"accounts", "categories",
+                                                  "operations"};
+  size_t section_ = 0;
+  size_t written_ = 0;
+  bool opened_ = false;
+
  public:
   void visit(const BankAccount& account) override {
     std::stringstream ss;
@@ -198,8 +235,11 @@ class JSONExportVisitor : public IExportVisitor {
        << "      \"type\": \"" << categoryTypeToString(category.getType())
        << "\",\n"
        << "      \"name\": \"" << category.getName() << "\",\n"
-       << "      \"description\": \"" << category.getDescription() << "\"\n"
-       << "    }";
+       << "      \"description\": \"" << category.getDescription() << "\"";
+    if (!category.isRoot()) {
+      ss << ",\n      \"parentId\": \"" << category.getParentId() << "\"";
+    }
+    ss << "\n    }";
     categories_.push_back(ss.str());
   }
 
@@ -263,74 +303,264 @@ class JSONExportVisitor : public IExportVisitor {
     accounts_.clear();
     categories_.clear();
     operations_.clear();
+    section_ = 0;
+    written_ = 0;
+    opened_ = false;
+  }
+
+  // Элемент окончателен сразу: запятая пишется перед следующим.
+  // Раздел закрывается, когда появились элементы следующего
+  void takeReady(std::string& out) override {
+    if (!opened_) {
+      out += "{\n  \"accounts\": [\n";
+      opened_ = true;
+    }
+    while (true) {
+      flushSection(out);
+      if (section_ + 1 >= 3 || !hasLaterElements()) break;
+      nextSection(out);
+    }
+  }
+
+  void takeRest(std::string& out) override {
+    takeReady(out);
+    while (section_ + 1 < 3) nextSection(out);
+    flushSection(out);
+    out += written_ > 0 ? "\n  ]\n}" : "  ]\n}";
+  }
+
+ private:
+  std::vector<std::string>& sectionItems(size_t section) {
+    return section == 0 ? accounts_ : section == 1 ? categories_ : operations_;
+  }
+
+  bool hasLaterElements() {
+    for (size_t s = section_ + 1; s < 3; ++s) {
+      if (!sectionItems(s).empty()) return true;
+    }
+    return false;
   }
+
+  void flushSection(std::string& out) {
+    auto& items = sectionItems(section_);
+    for (auto& item : items) {
+      if (written_++ > 0) out += ",\n";
+      out += item;
+    }
+    items.clear();
+  }
+
+  void nextSection(std::string& out) {
+    flushSection(out);
+    out += written_ > 0 ? "\n  ],\n" : "  ],\n";
+    section_++;
+    written_ = 0;
+    out += "  \"";
+    out += SECTION_NAMES[section_];
+    out += "\": [\n";
+  }
+};
+
+// Посетитель колоночного экспорта для аналитики (формат описан
+// в columnar_format.h). В файл попадают только операции: счета
+// и категории для анализа выгружаются обычным экспортом
+class ColumnarExportVisitor : public IExportVisitor {
+ private:
+  columnar::ColumnarWriter writer_;
+
+ public:
+  explicit ColumnarExportVisitor(
+      size_t rowGroupSize = columnar::ColumnarWriter::DEFAULT_ROW_GROUP_SIZE)
+      : writer_(rowGroupSize) {}
+
+  void visit(const BankAccount&) override {}
+  void visit(const Category&) override {}
+
+  void visit(const Operation& operation) override {
+    writer_.add(operation.getId(), operationTypeToString(operation.getType()),
+                operation.getBankAccountId(),
+                operation.getAmount().getAmount(),
+                operation.getAmount().getCurrency(),
+                std::chrono::duration_cast<std::chrono::seconds>(
+                    operation.getDate().time_since_epoch())
+                    .count(),
+                operation.getCategoryId(), operation.getDescription());
+  }
+
+  std::string getResult() const override {
+    columnar::ColumnarWriter copy = writer_;
+    std::string result;
+    copy.finish(result);
+    return result;
+  }
+
+  void reset() override { writer_.reset(); }
+
+  // Отдаются закрытые группы строк, незаполненная остаётся в памяти
+  void takeReady(std::string& out) override { writer_.takeReady(out); }
+
+  void takeRest(std::string& out) override { writer_.finish(out); }
 };
 
 // Экспортер данных с использованием паттерна посетитель
 class DataExporter {
  private:
+  static constexpr size_t FLUSH_EVERY = 4096;
+
   std::unique_ptr<IExportVisitor> visitor_;
+  std::shared_ptr<ThreadPool> pool_;
+  int compressionLevel_ = Gzip::DEFAULT_LEVEL;
+  CompressionStats lastCompressionStats_;
 
  public:
+  // Источник операций: вызывает sink для каждой операции по очереди.
+  // Позволяет передать выборку из репозитория прямо в посетителя,
+  // не собирая её в промежуточный вектор
+  using OperationSink = std::function<void(const Operation&)>;
+  using OperationSource = std::function<void(const OperationSink&)>;
+
   explicit DataExporter(std::unique_ptr<IExportVisitor> visitor)
       : visitor_(std::move(visitor)) {}
 
+  // Пул для сжатия параллельно с форматированием; без него сжатый
+  // экспорт сжимает каждую порцию сразу
+  void setThreadPool(std::shared_ptr<ThreadPool> pool) {
+    pool_ = std::move(pool);
+  }
+
+  // Уровень сжатия файлов .gz (Gzip::MIN_LEVEL..Gzip::MAX_LEVEL)
+  void setCompressionLevel(int level) {
+    if (!Gzip::isValidLevel(level)) {
+      throw std::invalid_argument("Недопустимый уровень сжатия: " +
+                                  std::to_string(level));
+    }
+    compressionLevel_ = level;
+  }
+
+  int compressionLevel() const { return compressionLevel_; }
+
   void exportToFile(const std::string& filename,
                     const std::vector<std::shared_ptr<BankAccount>>& accounts,
                     const std::vector<std::shared_ptr<Category>>& categories,
                     const std::vector<std::shared_ptr<Operation>>& operations) {
-    visitor_->reset();
-
-    // Посетить все счета
-    for (const auto& account : accounts) {
-      ExportableBankAccount exportable(*account);
-      exportable.accept(*visitor_);
-    }
+    exportToFile(filename, accounts, categories, fromVector(operations));
+  }
 
-    // Посетить все категории
-    for (const auto& category : categories) {
-      ExportableCategory exportable(*category);
-      exportable.accept(*visitor_);
-    }
+  void exportToFile(const std::string& filename,
+                    const std::vector<std::shared_ptr<BankAccount>>& accounts,
+                    const std::vector<std::shared_ptr<Category>>& categories,
+                    const OperationSource& operations) {
+    // Запись (и сжатие) идёт задачей пула параллельно с форматированием
+    std::unique_ptr<AsyncFileWriter> writer =
+        Gzip::hasExtension(filename)
+            ? std::make_unique<GzipFileWriter>(filename, pool_.get(),
+                                               compressionLevel_)
+            : std::make_unique<AsyncFileWriter>(filename, pool_.get());
+    visitAll(accounts, categories, operations,
+             [&writer](std::string chunk) { writer->write(std::move(chunk)); });
+    CompressionStats stats = writer->finish();
+    if (Gzip::hasExtension(filename)) lastCompressionStats_ = stats;
+  }
 
-    // Посетить все операции
-    for (const auto& operation : operations) {
-      ExportableOperation exportable(*operation);
-      exportable.accept(*visitor_);
+  // Асинхронный экспорт задачей пула; сущности копируются в задачу.
+  // До готовности результата экспортер не используется; ждать его
+  // из задачи того же пула нельзя. Без пула экспорт выполняется сразу
+  std::future<void> exportToFileAsync(
+      const std::string& filename,
+      std::vector<std::shared_ptr<BankAccount>> accounts,
+      std::vector<std::shared_ptr<Category>> categories,
+      std::vector<std::shared_ptr<Operation>> operations) {
+    auto task = [this, filename, accounts = std::move(accounts),
+                 categories = std::move(categories),
+                 operations = std::move(operations)]() {
+      exportToFile(filename, accounts, categories, operations);
+    };
+    if (pool_) return pool_->submit(std::move(task));
+
+    std::promise<void> promise;
+    try {
+      task();
+      promise.set_value();
+    } catch (...) {
+      promise.set_exception(std::current_exception());
     }
+    return promise.get_future();
+  }
 
-    // Записать в файл
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-      throw InfrastructureException("Невозможно создать файл: " + filename);
-    }
+  // Размеры и скорость последнего сжатого экспорта
+  const CompressionStats& lastCompressionStats() const {
+    return lastCompressionStats_;
+  }
 
-    file << visitor_->getResult();
-    file.close();
+  std::string exportToString(
+      const std::vector<std::shared_ptr<BankAccount>>& accounts,
+      const std::vector<std::shared_ptr<Category>>& categories,
+      const std::vector<std::shared_ptr<Operation>>& operations) {
+    return exportToString(accounts, categories, fromVector(operations));
   }
 
   std::string exportToString(
       const std::vector<std::shared_ptr<BankAccount>>& accounts,
       const std::vector<std::shared_ptr<Category>>& categories,
+      const OperationSource& operations) {
+    visitAll(accounts, categories, operations);
+    return visitor_->getResult();
+  }
+
+ private:
+  static OperationSource fromVector(
       const std::vector<std::shared_ptr<Operation>>& operations) {
+    return [&operations](const OperationSink& sink) {
+      for (const auto& operation : operations) sink(*operation);
+    };
+  }
+
+  void visitAll(const std::vector<std::shared_ptr<BankAccount>>& accounts,
+                const std::vector<std::shared_ptr<Category>>& categories,
+                const OperationSource& operations) {
     visitor_->reset();
 
+    // Посетить все счета
     for (const auto& account : accounts) {
       ExportableBankAccount exportable(*account);
       exportable.accept(*visitor_);
     }
 
+    // Посетить все категории
     for (const auto& category : categories) {
       ExportableCategory exportable(*category);
       exportable.accept(*visitor_);
     }
 
-    for (const auto& operation : operations) {
-      ExportableOperation exportable(*operation);
+    // Посетить операции по мере поступления из источника
+    operations([this](const Operation& operation) {
+      ExportableOperation exportable(operation);
       exportable.accept(*visitor_);
-    }
+    });
+  }
 
-    return visitor_->getResult();
+  // То же с потоковой отдачей результата: готовая часть передаётся
+  // в write каждые FLUSH_EVERY операций
+  template <typename Write>
+  void visitAll(const std::vector<std::shared_ptr<BankAccount>>& accounts,
+                const std::vector<std::shared_ptr<Category>>& categories,
+                const OperationSource& operations, Write write) {
+    size_t pending = 0;
+    OperationSource batched = [&](const OperationSink& sink) {
+      operations([&](const Operation& operation) {
+        sink(operation);
+        if (++pending < FLUSH_EVERY) return;
+        pending = 0;
+        std::string chunk;
+        visitor_->takeReady(chunk);
+        write(std::move(chunk));
+      });
+    };
+    visitAll(accounts, categories, batched);
+
+    std::string rest;
+    visitor_->takeRest(rest);
+    write(std::move(rest));
   }
 };
 
@@ -346,6 +576,10 @@ class ExporterFactory {
       return std::make_unique<DataExporter>(
           std::make_unique<JSONExportVisitor>());
     }
+    if (format == "fcol" || format == "columnar") {
+      return std::make_unique<DataExporter>(
+          std::make_unique<ColumnarExportVisitor>());
+    }
     throw std::invalid_argument("Неподдерживаемый формат экспорта: " + format);
   }
 };
@@ -1,11 +1,31 @@
 #pragma once
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <deque>
 #include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "common/error_codes.h"
 #include "common/exceptions.h"
+#include "common/striped_hash_set.h"
+#include "common/thread_pool.h"
+#include "common/utils.h"
+#include "infrastructure/serialization/async_file.h"
+#include "infrastructure/serialization/columnar_format.h"
+#include "infrastructure/serialization/compression.h"
+#include "infrastructure/serialization/json_import_pipeline.h"
 
 namespace financial::infrastructure {
 using namespace financial::domain;
@@ -25,6 +45,7 @@ struct CategoryDTO {
   std::string type;
   std::string name;
   std::string description;
+  std::string parentId;
 };
 
 struct OperationDTO {
@@ -44,13 +65,310 @@ struct ImportData {
   std::vector<OperationDTO> operations;
 };
 
+// Представления записей импорта: строки указывают во входной буфер
+// (ImportView::storage), сумма и дата разобраны при чтении. Поля
+// называются так же, как в DTO, поэтому проверка и загрузка общие
+struct AccountView {
+  std::string_view id;
+  std::string_view name;
+  double balance = 0.0;
+  std::string_view currency;
+  std::string_view accountNumber;
+  bool isActive = false;
+
+  AccountDTO toDTO() const {
+    return {std::string(id),       std::string(name),
+            balance,               std::string(currency),
+            std::string(accountNumber), isActive};
+  }
+};
+
+struct CategoryView {
+  std::string_view id;
+  std::string_view type;
+  std::string_view name;
+  std::string_view description;
+  std::string_view parentId;
+
+  CategoryDTO toDTO() const {
+    return {std::string(id), std::string(type), std::string(name),
+            std::string(description), std::string(parentId)};
+  }
+};
+
+struct OperationView {
+  std::string_view id;
+  std::string_view type;
+  std::string_view bankAccountId;
+  double amount = 0.0;
+  std::string_view currency;
+  std::string_view date;
+  std::string_view categoryId;
+  std::string_view description;
+  std::optional<DateTime> parsedDate;  // пусто, если дата некорректна
+
+  OperationDTO toDTO() const {
+    return {std::string(id),         std::string(type),
+            std::string(bankAccountId), amount,
+            std::string(currency),   std::string(date),
+            std::string(categoryId), std::string(description)};
+  }
+};
+
+// Данные импорта без копирования строк полей. Фрагменты входа лежат
+// в storage: deque не перемещает элементы при росте, а при перемещении
+// всего ImportView передаёт их вместе с памятью, поэтому представления
+// остаются действительными. Копия запрещена — она ссылалась бы на
+// чужой буфер
+struct ImportView {
+  std::deque<std::string> storage;
+  std::vector<AccountView> accounts;
+  std::vector<CategoryView> categories;
+  std::vector<OperationView> operations;
+
+  ImportView() = default;
+  ImportView(ImportView&&) = default;
+  ImportView& operator=(ImportView&&) = default;
+  ImportView(const ImportView&) = delete;
+  ImportView& operator=(const ImportView&) = delete;
+};
+
+// Ошибка в строке импортируемого файла; field — строковый литерал
+struct ValidationIssue {
+  enum class Section : uint8_t { ACCOUNT, CATEGORY, OPERATION };
+
+  Section section;
+  ErrorCode code;
+  uint32_t row;
+  const char* field;
+};
+
+inline const char* sectionToString(ValidationIssue::Section section) {
+  switch (section) {
+    case ValidationIssue::Section::ACCOUNT: return "счёт";
+    case ValidationIssue::Section::CATEGORY: return "категория";
+    case ValidationIssue::Section::OPERATION: return "операция";
+  }
+  return "";
+}
+
+// Итог проверки: все найденные ошибки, а не только первая,
+// и скорость проверки
+struct ValidationReport {
+  std::vector<ValidationIssue> issues;
+  size_t rowsChecked = 0;
+  double seconds = 0.0;
+
+  bool isValid() const { return issues.empty(); }
+
+  double rowsPerSecond() const {
+    return seconds > 0.0 ? static_cast<double>(rowsChecked) / seconds : 0.0;
+  }
+
+  std::string summary(size_t maxIssues = 10) const {
+    std::ostringstream out;
+    out << "Ошибок проверки: " << issues.size() << " (строк: " << rowsChecked
+        << ")";
+    for (size_t i = 0; i < issues.size() && i < maxIssues; ++i) {
+      const auto& issue = issues[i];
+      out << "\n  " << sectionToString(issue.section) << " #"
+          << issue.row + 1 << ", " << issue.field << ": "
+          << errorCodeToString(issue.code);
+    }
+    if (issues.size() > maxIssues) {
+      out << "\n  ... и ещё " << issues.size() - maxIssues;
+    }
+    return out.str();
+  }
+};
+
+// Параллельная проверка импортируемых данных. Строки делятся на блоки,
+// которые проверяются задачами общего пула потоков (без пула — по
+// очереди в вызывающем потоке); ошибки копятся в локальных векторах
+// и сливаются в конце. Повторы id ищутся
+// в сегментированном хеш-множестве, ссылки операций проверяются
+// по множествам id счетов и категорий из того же файла — если
+// соответствующий раздел в файле есть. Data — ImportData или ImportView:
+// поля записей у них называются одинаково.
+template <typename Data>
+class BasicImportValidator {
+ private:
+  static constexpr size_t CHUNK_ROWS = 4096;
+
+  using Section = ValidationIssue::Section;
+  using IdSet = StripedHashSet<std::string_view>;
+
+  const Data& data_;
+  ThreadPool* pool_;
+  IdSet accountIds_;
+  IdSet categoryIds_;
+  IdSet operationIds_;
+  std::mutex issuesMutex_;
+  std::vector<ValidationIssue> issues_;
+
+ public:
+  explicit BasicImportValidator(const Data& data, ThreadPool* pool = nullptr)
+      : data_(data), pool_(pool) {}
+
+  ValidationReport run() {
+    auto start = std::chrono::steady_clock::now();
+
+    accountIds_.reserve(data_.accounts.size());
+    categoryIds_.reserve(data_.categories.size());
+    operationIds_.reserve(data_.operations.size());
+
+    forEachChunk(data_.accounts.size(), [this](size_t row, auto& issues) {
+      checkAccount(row, issues);
+    });
+    forEachChunk(data_.categories.size(), [this](size_t row, auto& issues) {
+      checkCategory(row, issues);
+    });
+    // Операции проверяются после того, как множества id счетов
+    // и категорий заполнены целиком
+    forEachChunk(data_.operations.size(), [this](size_t row, auto& issues) {
+      checkOperation(row, issues);
+    });
+
+    ValidationReport report;
+    report.issues = std::move(issues_);
+    std::sort(report.issues.begin(), report.issues.end(),
+              [](const ValidationIssue& a, const ValidationIssue& b) {
+                if (a.section != b.section) return a.section < b.section;
+                return a.row < b.row;
+              });
+    report.rowsChecked = data_.accounts.size() + data_.categories.size() +
+                         data_.operations.size();
+    report.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    return report;
+  }
+
+ private:
+  template <typename Check>
+  void forEachChunk(size_t rows, Check check) {
+    parallelFor(pool_, 0, rows, CHUNK_ROWS, [&](size_t from, size_t to) {
+      std::vector<ValidationIssue> local;
+      for (size_t row = from; row < to; ++row) check(row, local);
+      if (local.empty()) return;
+      std::lock_guard<std::mutex> lock(issuesMutex_);
+      issues_.insert(issues_.end(), local.begin(), local.end());
+    });
+  }
+
+  static void report(std::vector<ValidationIssue>& issues, Section section,
+                     size_t row, const char* field, ErrorCode code) {
+    issues.push_back({section, code, static_cast<uint32_t>(row), field});
+  }
+
+  static bool isValidCurrency(std::string_view currency) {
+    return !currency.empty() && currency.size() <= 3;
+  }
+
+  static bool isValidType(std::string_view type) {
+    return type == "INCOME" || type == "EXPENSE";
+  }
+
+  void checkId(IdSet& ids, std::string_view id, Section section, size_t row,
+               std::vector<ValidationIssue>& issues) {
+    if (id.empty()) {
+      report(issues, section, row, "id", ErrorCode::EMPTY_VALUE);
+    } else if (!ids.insert(id)) {
+      report(issues, section, row, "id", ErrorCode::DUPLICATE_ID);
+    }
+  }
+
+  void checkAccount(size_t row, std::vector<ValidationIssue>& issues) {
+    const auto& account = data_.accounts[row];
+    checkId(accountIds_, account.id, Section::ACCOUNT, row, issues);
+    if (account.name.empty()) {
+      report(issues, Section::ACCOUNT, row, "name", ErrorCode::EMPTY_VALUE);
+    }
+    if (!std::isfinite(account.balance) || account.balance < 0) {
+      report(issues, Section::ACCOUNT, row, "balance",
+             ErrorCode::NEGATIVE_VALUE);
+    }
+    if (!isValidCurrency(account.currency)) {
+      report(issues, Section::ACCOUNT, row, "currency",
+             ErrorCode::INVALID_FORMAT);
+    }
+  }
+
+  void checkCategory(size_t row, std::vector<ValidationIssue>& issues) {
+    const auto& category = data_.categories[row];
+    checkId(categoryIds_, category.id, Section::CATEGORY, row, issues);
+    if (category.name.empty()) {
+      report(issues, Section::CATEGORY, row, "name", ErrorCode::EMPTY_VALUE);
+    }
+    if (!isValidType(category.type)) {
+      report(issues, Section::CATEGORY, row, "type", ErrorCode::INVALID_FORMAT);
+    }
+  }
+
+  void checkReference(IdSet& ids, bool sectionPresent, std::string_view id,
+                      size_t row, const char* field,
+                      std::vector<ValidationIssue>& issues) {
+    if (id.empty()) {
+      report(issues, Section::OPERATION, row, field, ErrorCode::EMPTY_VALUE);
+    } else if (sectionPresent && !ids.contains(id)) {
+      report(issues, Section::OPERATION, row, field,
+             ErrorCode::UNKNOWN_REFERENCE);
+    }
+  }
+
+  void checkOperation(size_t row, std::vector<ValidationIssue>& issues) {
+    const auto& operation = data_.operations[row];
+    checkId(operationIds_, operation.id, Section::OPERATION, row, issues);
+    checkReference(accountIds_, !data_.accounts.empty(),
+                   operation.bankAccountId, row, "bankAccountId", issues);
+    checkReference(categoryIds_, !data_.categories.empty(),
+                   operation.categoryId, row, "categoryId", issues);
+    if (!isValidType(operation.type)) {
+      report(issues, Section::OPERATION, row, "type",
+             ErrorCode::INVALID_FORMAT);
+    }
+    if (!std::isfinite(operation.amount) || operation.amount <= 0) {
+      report(issues, Section::OPERATION, row, "amount",
+             ErrorCode::NOT_POSITIVE);
+    }
+    if (!isValidCurrency(operation.currency)) {
+      report(issues, Section::OPERATION, row, "currency",
+             ErrorCode::INVALID_FORMAT);
+    }
+    if (!hasValidDate(operation)) {
+      report(issues, Section::OPERATION, row, "date",
+             ErrorCode::INVALID_FORMAT);
+    }
+  }
+
+  static bool hasValidDate(const OperationDTO& operation) {
+    std::tm fields;
+    return DateTimeUtils::tryParseFields(operation.date, fields);
+  }
+
+  // Дату представления importViews уже разобрал при чтении
+  static bool hasValidDate(const OperationView& operation) {
+    return operation.parsedDate.has_value();
+  }
+};
+
+using ImportValidator = BasicImportValidator<ImportData>;
+
 // Шаблонный метод для импорта данных
 class DataImporter {
- protected:
-  // Шаблонный метод
+ private:
+  ValidationReport lastReport_;
+  std::shared_ptr<ThreadPool> pool_;
+
  public:
   virtual ~DataImporter() = default;
 
+  // Пул для параллельной проверки; без него проверка последовательная
+  void setThreadPool(std::shared_ptr<ThreadPool> pool) {
+    pool_ = std::move(pool);
+  }
+
+  // Шаблонный метод
   ImportData import(const std::string& filename) {
     // Открыть файл
     std::ifstream file = openFile(filename);
@@ -62,63 +380,188 @@ class DataImporter {
     ImportData data = parseContent(content);
 
     // Проверить данные
-    validateData(data);
+    lastReport_ = validateData(data);
 
     // Закрыть файл
     closeFile(file);
 
+    if (!lastReport_.isValid()) {
+      throw ValidationException(lastReport_.summary());
+    }
     return data;
   }
 
+  // Асинхронный импорт задачей пула: файл читается фрагментами
+  // с упреждением, сжатый распаковывается по мере чтения. До готовности
+  // результата импортер не используется; ждать его из задачи того же
+  // пула нельзя. Без пула импорт выполняется сразу, а результат
+  // возвращается готовым
+  std::future<ImportData> importAsync(const std::string& filename) {
+    if (!pool_) {
+      std::promise<ImportData> promise;
+      try {
+        promise.set_value(importWithReadAhead(filename));
+      } catch (...) {
+        promise.set_exception(std::current_exception());
+      }
+      return promise.get_future();
+    }
+    return pool_->submit(
+        [this, filename]() { return importWithReadAhead(filename); });
+  }
+
+  // Отчёт последней проверки, в том числе неудачной
+  const ValidationReport& lastReport() const { return lastReport_; }
+
  protected:
   // Общие шаги
   virtual std::ifstream openFile(const std::string& filename) {
-    std::ifstream file(filename);
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
       throw InfrastructureException("Невозможно открыть файл: " + filename);
     }
     return file;
   }
 
+  // Сжатый gzip файл распознаётся по сигнатуре и распаковывается
+  // прозрачно, независимо от расширения
   virtual std::string readContent(std::ifstream& file) {
     std::stringstream buffer;
     buffer << file.rdbuf();
-    return buffer.str();
+    std::string content = buffer.str();
+    if (Gzip::isCompressed(content)) return Gzip::decompress(content);
+    return content;
   }
 
   virtual void closeFile(std::ifstream& file) { file.close(); }
 
-  virtual void validateData(const ImportData& data) {
-    // Базовая проверка
-    for (const auto& account : data.accounts) {
-      if (account.id.empty() || account.name.empty()) {
-        throw ValidationException("Неверные данные счёта");
+  // Пока фрагмент распаковывается или копируется, следующий уже читается
+  virtual std::string readChunked(AsyncFileReader& reader) {
+    std::string content;
+    std::string chunk;
+    std::unique_ptr<GzipInflater> inflater;
+    bool first = true;
+    while (reader.next(chunk)) {
+      if (first && Gzip::isCompressed(chunk)) {
+        inflater = std::make_unique<GzipInflater>();
       }
-    }
-
-    for (const auto& category : data.categories) {
-      if (category.id.empty() || category.name.empty()) {
-        throw ValidationException("Неверные данные категории");
+      first = false;
+      if (inflater) {
+        inflater->feed(chunk, content);
+      } else {
+        content += chunk;
       }
     }
+    if (inflater) inflater->finish();
+    return content;
+  }
 
-    for (const auto& operation : data.operations) {
-      if (operation.id.empty() || operation.bankAccountId.empty() ||
-          operation.categoryId.empty() || operation.amount <= 0) {
-        throw ValidationException("Неверные данные операции");
-      }
-    }
+  virtual ValidationReport validateData(const ImportData& data) {
+    return ImportValidator(data, pool_.get()).run();
   }
 
   virtual ImportData parseContent(const std::string& content) = 0;
+
+  // Проверка записей в любом представлении; отчёт сохраняется
+  template <typename Data>
+  void validateOrThrow(const Data& data) {
+    lastReport_ = BasicImportValidator<Data>(data, pool_.get()).run();
+    if (!lastReport_.isValid()) {
+      throw ValidationException(lastReport_.summary());
+    }
+  }
+
+  // Чтение и разбор для importAsync: по умолчанию файл собирается
+  // из фрагментов, прочитанных с упреждением, и разбирается целиком
+  virtual ImportData readAndParseAhead(const std::string& filename) {
+    AsyncFileReader reader(filename, pool_.get());
+    return parseContent(readChunked(reader));
+  }
+
+ private:
+  ImportData importWithReadAhead(const std::string& filename) {
+    ImportData data = readAndParseAhead(filename);
+    lastReport_ = validateData(data);
+    if (!lastReport_.isValid()) {
+      throw ValidationException(lastReport_.summary());
+    }
+    return data;
+  }
 };
 
 // Импортер JSON  - ручной парсинг
 class JSONImporter : public DataImporter {
+ private:
+  JsonPipelineMetrics lastPipelineMetrics_;
+
  public:
   ~JSONImporter() override = default;
 
+  // Импорт без копирования строк полей: объекты из конвейера переходят
+  // в ImportView::storage, записи указывают в них, сумма и дата
+  // разбираются сразу. Строки копируются один раз — при создании
+  // сущностей из представлений
+  ImportView importViews(const std::string& filename) {
+    ImportView view;
+    lastPipelineMetrics_ = JsonImportPipeline().run(
+        filename, [&view](JsonSection section, std::string& obj) {
+          if (section == JsonSection::NONE) return;
+          std::string_view text = view.storage.emplace_back(std::move(obj));
+          switch (section) {
+            case JsonSection::ACCOUNTS: {
+              AccountView account = parseAccountView(text);
+              if (!account.id.empty()) view.accounts.push_back(account);
+              break;
+            }
+            case JsonSection::CATEGORIES: {
+              CategoryView category = parseCategoryView(text);
+              if (!category.id.empty()) view.categories.push_back(category);
+              break;
+            }
+            case JsonSection::OPERATIONS: {
+              OperationView operation = parseOperationView(text);
+              if (operation.id.empty()) break;
+              operation.parsedDate = DateTimeUtils::tryParse(operation.date);
+              view.operations.push_back(operation);
+              break;
+            }
+            case JsonSection::NONE:
+              break;
+          }
+        });
+    validateOrThrow(view);
+    return view;
+  }
+
+  // Загрузка стадий конвейера последнего importAsync или importViews
+  const JsonPipelineMetrics& lastPipelineMetrics() const {
+    return lastPipelineMetrics_;
+  }
+
  protected:
+  // Чтение, нарезка на объекты и разбор полей идут конвейером:
+  // пока объекты одного блока разбираются, следующий уже читается
+  ImportData readAndParseAhead(const std::string& filename) override {
+    ImportData data;
+    lastPipelineMetrics_ = JsonImportPipeline().run(
+        filename, [this, &data](JsonSection section, const std::string& obj) {
+          switch (section) {
+            case JsonSection::ACCOUNTS:
+              parseAccount(obj, data.accounts);
+              break;
+            case JsonSection::CATEGORIES:
+              parseCategory(obj, data.categories);
+              break;
+            case JsonSection::OPERATIONS:
+              parseOperation(obj, data.operations);
+              break;
+            case JsonSection::NONE:
+              break;
+          }
+        });
+    return data;
+  }
+
   ImportData parseContent(const std::string& content) override {
     ImportData data;
 
@@ -161,50 +604,86 @@ class JSONImporter : public DataImporter {
   }
 
  private:
-  std::string extractString(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) return "";
+  // Позиция сразу за "key": или npos; ключ ищется без построения строки
+  static size_t findKey(std::string_view json, std::string_view key) {
+    for (size_t pos = json.find(key); pos != std::string_view::npos;
+         pos = json.find(key, pos + 1)) {
+      size_t end = pos + key.size();
+      if (pos > 0 && json[pos - 1] == '"' && end + 1 < json.size() &&
+          json[end] == '"' && json[end + 1] == ':') {
+        return end + 2;
+      }
+    }
+    return std::string_view::npos;
+  }
+
+  static std::string_view extractString(std::string_view json,
+                                        std::string_view key) {
+    size_t pos = findKey(json, key);
+    if (pos == std::string_view::npos) return {};
 
-    size_t valueStart = json.find('"', pos + searchKey.length());
-    if (valueStart == std::string::npos) return "";
+    size_t valueStart = json.find('"', pos);
+    if (valueStart == std::string_view::npos) return {};
 
     size_t valueEnd = json.find('"', valueStart + 1);
-    if (valueEnd == std::string::npos) return "";
+    if (valueEnd == std::string_view::npos) return {};
 
     return json.substr(valueStart + 1, valueEnd - valueStart - 1);
   }
 
-  double extractNumber(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) return 0.0;
-
-    size_t valueStart = pos + searchKey.length();
-    while (valueStart < json.length() && std::isspace(json[valueStart])) {
+  // Число разбирается std::from_chars прямо во входном буфере
+  static double extractNumber(std::string_view json, std::string_view key) {
+    size_t valueStart = findKey(json, key);
+    if (valueStart == std::string_view::npos) return 0.0;
+    while (valueStart < json.size() &&
+           std::isspace(static_cast<unsigned char>(json[valueStart]))) {
       valueStart++;
     }
 
-    size_t valueEnd = valueStart;
-    while (valueEnd < json.length() &&
-           (std::isdigit(json[valueEnd]) || json[valueEnd] == '.' ||
-            json[valueEnd] == '-')) {
-      valueEnd++;
-    }
+    double value = 0.0;
+    const char* first = json.data() + valueStart;
+    auto result = std::from_chars(first, json.data() + json.size(), value);
+    return result.ec == std::errc() ? value : 0.0;
+  }
 
-    if (valueEnd > valueStart) {
-      return std::stod(json.substr(valueStart, valueEnd - valueStart));
-    }
-    return 0.0;
+  static bool extractBool(std::string_view json, std::string_view key) {
+    size_t valueStart = findKey(json, key);
+    if (valueStart == std::string_view::npos) return false;
+    return json.find("true", valueStart) < json.find("false", valueStart);
   }
 
-  bool extractBool(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) return false;
+  static AccountView parseAccountView(std::string_view obj) {
+    AccountView account;
+    account.id = extractString(obj, "id");
+    account.name = extractString(obj, "name");
+    account.balance = extractNumber(obj, "balance");
+    account.currency = extractString(obj, "currency");
+    account.accountNumber = extractString(obj, "accountNumber");
+    account.isActive = extractBool(obj, "isActive");
+    return account;
+  }
 
-    size_t valueStart = pos + searchKey.length();
-    return json.find("true", valueStart) < json.find("false", valueStart);
+  static CategoryView parseCategoryView(std::string_view obj) {
+    CategoryView category;
+    category.id = extractString(obj, "id");
+    category.type = extractString(obj, "type");
+    category.name = extractString(obj, "name");
+    category.description = extractString(obj, "description");
+    category.parentId = extractString(obj, "parentId");
+    return category;
+  }
+
+  static OperationView parseOperationView(std::string_view obj) {
+    OperationView operation;
+    operation.id = extractString(obj, "id");
+    operation.type = extractString(obj, "type");
+    operation.bankAccountId = extractString(obj, "bankAccountId");
+    operation.amount = extractNumber(obj, "amount");
+    operation.currency = extractString(obj, "currency");
+    operation.date = extractString(obj, "date");
+    operation.categoryId = extractString(obj, "categoryId");
+    operation.description = extractString(obj, "description");
+    return operation;
   }
 
   std::vector<std::string> splitObjects(const std::string& arrayContent) {
@@ -244,17 +723,14 @@ class JSONImporter : public DataImporter {
     auto objects = splitObjects(arrayContent);
 
     for (const auto& obj : objects) {
-      AccountDTO account;
-      account.id = extractString(obj, "id");
-      account.name = extractString(obj, "name");
-      account.balance = extractNumber(obj, "balance");
-      account.currency = extractString(obj, "currency");
-      account.accountNumber = extractString(obj, "accountNumber");
-      account.isActive = extractBool(obj, "isActive");
-
-      if (!account.id.empty()) {
-        accounts.push_back(account);
-      }
+      parseAccount(obj, accounts);
+    }
+  }
+
+  void parseAccount(std::string_view obj, std::vector<AccountDTO>& accounts) {
+    AccountView account = parseAccountView(obj);
+    if (!account.id.empty()) {
+      accounts.push_back(account.toDTO());
     }
   }
 
@@ -263,15 +739,15 @@ class JSONImporter : public DataImporter {
     auto objects = splitObjects(arrayContent);
 
     for (const auto& obj : objects) {
-      CategoryDTO category;
-      category.id = extractString(obj, "id");
-      category.type = extractString(obj, "type");
-      category.name = extractString(obj, "name");
-      category.description = extractString(obj, "description");
-
-      if (!category.id.empty()) {
-        categories.push_back(category);
-      }
+      parseCategory(obj, categories);
+    }
+  }
+
+  void parseCategory(std::string_view obj,
+                     std::vector<CategoryDTO>& categories) {
+    CategoryView category = parseCategoryView(obj);
+    if (!category.id.empty()) {
+      categories.push_back(category.toDTO());
     }
   }
 
@@ -280,20 +756,66 @@ class JSONImporter : public DataImporter {
     auto objects = splitObjects(arrayContent);
 
     for (const auto& obj : objects) {
-      OperationDTO operation;
-      operation.id = extractString(obj, "id");
-      operation.type = extractString(obj, "type");
-      operation.bankAccountId = extractString(obj, "bankAccountId");
-      operation.amount = extractNumber(obj, "amount");
-      operation.currency = extractString(obj, "currency");
-      operation.date = extractString(obj, "date");
-      operation.categoryId = extractString(obj, "categoryId");
-      operation.description = extractString(obj, "description");
-
-      if (!operation.id.empty()) {
-        operations.push_back(operation);
-      }
+      parseOperation(obj, operations);
+    }
+  }
+
+  void parseOperation(std::string_view obj,
+                      std::vector<OperationDTO>& operations) {
+    OperationView operation = parseOperationView(obj);
+    if (!operation.id.empty()) {
+      operations.push_back(operation.toDTO());
+    }
+  }
+};
+
+// Импорт операций из колоночного файла. Период задаёт отбор строк:
+// группы вне него отсекаются по статистике оглавления без декодирования
+class ColumnarImporter : public DataImporter {
+ private:
+  std::optional<std::pair<DateTime, DateTime>> period_;
+
+ public:
+  ColumnarImporter() = default;
+
+  ColumnarImporter(const DateTime& from, const DateTime& to)
+      : period_(std::make_pair(from, to)) {}
+
+ protected:
+  ImportData parseContent(const std::string& content) override {
+    columnar::ColumnarReader reader(content);
+
+    std::optional<std::pair<int64_t, int64_t>> seconds;
+    if (period_) {
+      seconds = std::make_pair(toSeconds(period_->first),
+                               toSeconds(period_->second));
     }
+
+    ImportData data;
+    data.operations.reserve(period_ ? 0 : reader.rowCount());
+    reader.scan(seconds, [&data](const columnar::OperationRows& rows,
+                                 size_t i) {
+      OperationDTO operation;
+      operation.id = rows.ids[i];
+      operation.type = rows.types[i];
+      operation.bankAccountId = rows.accountIds[i];
+      operation.amount = rows.amounts[i];
+      operation.currency = rows.currencies[i];
+      operation.date = DateTimeUtils::toString(
+          std::chrono::system_clock::from_time_t(
+              static_cast<std::time_t>(rows.dates[i])));
+      operation.categoryId = rows.categoryIds[i];
+      operation.description = rows.descriptions[i];
+      data.operations.push_back(std::move(operation));
+    });
+    return data;
+  }
+
+ private:
+  static int64_t toSeconds(const DateTime& date) {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               date.time_since_epoch())
+        .count();
   }
 };
 
@@ -304,12 +826,18 @@ class ImporterFactory {
     if (format == "json" || format == "JSON") {
       return std::make_unique<JSONImporter>();
     }
+    if (format == "fcol" || format == "columnar") {
+      return std::make_unique<ColumnarImporter>();
+    }
     throw std::invalid_argument("Неподдерживаемый формат импорта: " + format);
   }
 
+  // Для сжатых файлов формат берётся из расширения перед .gz
   static std::unique_ptr<DataImporter> createFromFilename(
       const std::string& filename) {
-    auto extension = filename.substr(filename.find_last_of('.') + 1);
+    std::string name = filename;
+    if (Gzip::hasExtension(name)) name.resize(name.size() - 3);
+    auto extension = name.substr(name.find_last_of('.') + 1);
     return create(extension);
   }
 };
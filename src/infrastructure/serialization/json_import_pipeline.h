@@ -0,0 +1,363 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/exceptions.h"
+#include "common/spsc_queue.h"
+#include "infrastructure/serialization/compression.h"
+
+namespace financial::infrastructure {
+
+// Массив верхнего уровня файла импорта, которому принадлежит объект
+enum class JsonSection : uint8_t { NONE, ACCOUNTS, CATEGORIES, OPERATIONS };
+
+// Потоковый разбор JSON на объекты массивов "accounts", "categories"
+// и "operations" верхнего уровня. Блоки подаются по мере чтения; объект,
+// строка или ключ, разрезанные границей блока, собираются из частей.
+// Поля объектов не разбираются — это дело следующей стадии
+class JsonObjectScanner {
+ public:
+  struct Object {
+    JsonSection section = JsonSection::NONE;
+    std::string text;
+  };
+
+ private:
+  // Глубина вложенности: 1 — корневой объект, 2 — массив секции,
+  // 3 — объект внутри него
+  static constexpr int SECTION_DEPTH = 2;
+
+  int depth_ = 0;
+  bool inString_ = false;
+  bool escaped_ = false;
+  bool recordingKey_ = false;
+  std::string lastString_;  // последняя строка корневого объекта
+  std::string key_;         // ключ, за которым идёт значение
+  JsonSection section_ = JsonSection::NONE;
+  bool capturing_ = false;
+  std::string object_;  // начало объекта из предыдущих блоков
+
+ public:
+  // emit(Object&&) вызывается для каждого завершённого объекта секции
+  template <typename Emit>
+  void feed(std::string_view block, Emit&& emit) {
+    size_t objectStart = 0;
+    for (size_t i = 0; i < block.size(); ++i) {
+      char c = block[i];
+      if (inString_) {
+        // Внутри строки интересны только кавычка и обратная косая
+        size_t end = i;
+        while (end < block.size() && (escaped_ || (block[end] != '"' &&
+                                                   block[end] != '\\'))) {
+          escaped_ = false;
+          ++end;
+        }
+        if (recordingKey_) lastString_.append(block.data() + i, end - i);
+        if (end == block.size()) break;
+        i = end;
+        if (block[i] == '\\') {
+          escaped_ = true;
+          if (recordingKey_) lastString_ += '\\';
+          continue;
+        }
+        inString_ = false;
+        recordingKey_ = false;
+        continue;
+      }
+
+      switch (c) {
+        case '"':
+          inString_ = true;
+          if (depth_ == 1) {
+            recordingKey_ = true;
+            lastString_.clear();
+          }
+          break;
+        case ':':
+          if (depth_ == 1) key_ = lastString_;
+          break;
+        case '{':
+        case '[':
+          ++depth_;
+          if (c == '[' && depth_ == SECTION_DEPTH) {
+            section_ = sectionFor(key_);
+          } else if (c == '{' && depth_ == SECTION_DEPTH + 1 &&
+                     section_ != JsonSection::NONE) {
+            capturing_ = true;
+            objectStart = i;
+          }
+          break;
+        case '}':
+        case ']':
+          if (depth_ == SECTION_DEPTH + 1 && capturing_ && c == '}') {
+            capturing_ = false;
+            object_.append(block.data() + objectStart, i + 1 - objectStart);
+            emit(Object{section_, std::move(object_)});
+            object_.clear();
+          }
+          if (depth_ == SECTION_DEPTH && c == ']') section_ = JsonSection::NONE;
+          if (depth_ > 0) --depth_;
+          break;
+        default:
+          break;
+      }
+    }
+    // Незакрытый объект продолжится в следующем блоке
+    if (capturing_) {
+      object_.append(block.data() + objectStart, block.size() - objectStart);
+    }
+  }
+
+  // Конец потока: объект секции не должен остаться незакрытым
+  void finish() const {
+    if (capturing_ || inString_) {
+      throw SerializationException("JSON оборван посреди объекта");
+    }
+  }
+
+ private:
+  static JsonSection sectionFor(const std::string& key) {
+    if (key == "accounts") return JsonSection::ACCOUNTS;
+    if (key == "categories") return JsonSection::CATEGORIES;
+    if (key == "operations") return JsonSection::OPERATIONS;
+    return JsonSection::NONE;
+  }
+};
+
+// Загрузка стадии конвейера: полезная работа и ожидание соседей
+struct PipelineStageMetrics {
+  uint64_t items = 0;
+  double busySeconds = 0.0;
+  double waitSeconds = 0.0;
+
+  double utilization() const {
+    double total = busySeconds + waitSeconds;
+    return total > 0.0 ? busySeconds / total : 0.0;
+  }
+};
+
+struct JsonPipelineMetrics {
+  PipelineStageMetrics read;   // items — блоки
+  PipelineStageMetrics scan;   // items — блоки
+  PipelineStageMetrics build;  // items — объекты
+  uint64_t bytesRead = 0;
+  size_t blockSize = 0;
+  size_t buffers = 0;
+  double seconds = 0.0;
+};
+
+// Конвейер импорта JSON из трёх стадий:
+//   чтение — поток читает файл блоками фиксированного размера в кольцо
+//            буферов (сжатый файл здесь же распаковывается);
+//   разбор — поток режет блоки на объекты (JsonObjectScanner) и
+//            возвращает буфер чтению;
+//   сборка — вызывающий поток строит из объектов DTO.
+// Стадии связаны ограниченными очередями SpscQueue, поэтому чтение
+// диска идёт параллельно с разбором, а память ограничена кольцом.
+//
+// Стадии — собственные потоки, а не задачи общего пула: они всё время
+// ждут друг друга, и в занятом пуле ожидающая стадия держала бы рабочего,
+// нужного соседней.
+class JsonImportPipeline {
+ public:
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+  static constexpr size_t DEFAULT_BUFFERS = 4;
+  static constexpr size_t BATCH_OBJECTS = 512;
+  static constexpr size_t BATCH_QUEUE = 4;
+
+  // Текст объекта можно забрать себе (std::move): после вызова
+  // конвейер его не использует
+  using Build = std::function<void(JsonSection, std::string&)>;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  using Batch = std::vector<JsonObjectScanner::Object>;
+
+  size_t blockSize_;
+  size_t buffers_;
+
+ public:
+  explicit JsonImportPipeline(size_t blockSize = DEFAULT_BLOCK_SIZE,
+                              size_t buffers = DEFAULT_BUFFERS)
+      : blockSize_(blockSize > 0 ? blockSize : DEFAULT_BLOCK_SIZE),
+        buffers_(buffers >= 2 ? buffers : 2) {}
+
+  // Прочитать файл; build вызывается в вызывающем потоке для каждого
+  // объекта по порядку следования в файле
+  JsonPipelineMetrics run(const std::string& filename, const Build& build) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+      throw InfrastructureException("Невозможно открыть файл: " + filename);
+    }
+
+    JsonPipelineMetrics metrics;
+    metrics.blockSize = blockSize_;
+    metrics.buffers = buffers_;
+    auto start = Clock::now();
+
+    SpscQueue<std::string> free(buffers_);
+    SpscQueue<std::string> filled(buffers_);
+    SpscQueue<Batch> batches(BATCH_QUEUE);
+    for (size_t i = 0; i < buffers_; ++i) {
+      std::string buffer;
+      buffer.reserve(blockSize_);
+      free.tryPush(buffer);
+    }
+
+    std::exception_ptr readError;
+    std::exception_ptr scanError;
+    std::thread reader([&]() {
+      readError = capture([&]() {
+        readStage(file, free, filled, metrics.read, metrics.bytesRead);
+      });
+      filled.close();
+    });
+    std::thread scanner([&]() {
+      scanError = capture(
+          [&]() { scanStage(filled, free, batches, metrics.scan); });
+      // Чтение не ждёт буферов, которые уже не вернутся
+      free.close();
+      filled.close();
+      batches.close();
+    });
+
+    std::exception_ptr buildError = capture(
+        [&]() { buildStage(batches, build, metrics.build); });
+    if (buildError) {
+      batches.close();
+      filled.close();
+      free.close();
+    }
+    reader.join();
+    scanner.join();
+
+    for (const auto& error : {readError, scanError, buildError}) {
+      if (error) std::rethrow_exception(error);
+    }
+    metrics.seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    return metrics;
+  }
+
+ private:
+  template <typename Fn>
+  static std::exception_ptr capture(Fn&& fn) {
+    try {
+      fn();
+    } catch (...) {
+      return std::current_exception();
+    }
+    return nullptr;
+  }
+
+  // Замер ожидания соседней стадии
+  template <typename Fn>
+  static bool waitFor(PipelineStageMetrics& stage, Fn&& fn) {
+    auto start = Clock::now();
+    bool result = fn();
+    stage.waitSeconds +=
+        std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+  }
+
+  static void finishStage(PipelineStageMetrics& stage,
+                          Clock::time_point start) {
+    double total = std::chrono::duration<double>(Clock::now() - start).count();
+    stage.busySeconds = total > stage.waitSeconds ? total - stage.waitSeconds
+                                                  : 0.0;
+  }
+
+  void readStage(std::ifstream& file, SpscQueue<std::string>& free,
+                 SpscQueue<std::string>& filled, PipelineStageMetrics& stage,
+                 uint64_t& bytesRead) const {
+    auto start = Clock::now();
+    std::unique_ptr<GzipInflater> inflater;
+    std::string compressed;
+    std::string block;
+    bool first = true;
+    while (waitFor(stage, [&]() { return free.pop(block); })) {
+      block.resize(blockSize_);
+      file.read(block.data(), static_cast<std::streamsize>(blockSize_));
+      block.resize(static_cast<size_t>(file.gcount()));
+      if (file.bad()) throw InfrastructureException("Ошибка чтения файла");
+      bytesRead += block.size();
+      bool endOfFile = file.eof() || block.empty();
+
+      if (first && Gzip::isCompressed(block)) {
+        inflater = std::make_unique<GzipInflater>();
+      }
+      first = false;
+      if (inflater) {
+        compressed.swap(block);
+        block.clear();
+        inflater->feed(compressed, block);
+      }
+
+      ++stage.items;
+      if (!waitFor(stage, [&]() { return filled.push(std::move(block)); })) {
+        break;
+      }
+      if (endOfFile) {
+        if (inflater) inflater->finish();
+        break;
+      }
+    }
+    finishStage(stage, start);
+  }
+
+  static void scanStage(SpscQueue<std::string>& filled,
+                        SpscQueue<std::string>& free, SpscQueue<Batch>& batches,
+                        PipelineStageMetrics& stage) {
+    auto start = Clock::now();
+    JsonObjectScanner scanner;
+    Batch batch;
+    batch.reserve(BATCH_OBJECTS);
+    bool cancelled = false;
+    std::string block;
+    while (!cancelled && waitFor(stage, [&]() { return filled.pop(block); })) {
+      scanner.feed(block, [&](JsonObjectScanner::Object&& object) {
+        batch.push_back(std::move(object));
+        if (batch.size() < BATCH_OBJECTS || cancelled) return;
+        cancelled = !waitFor(
+            stage, [&]() { return batches.push(std::move(batch)); });
+        batch = Batch();
+        batch.reserve(BATCH_OBJECTS);
+      });
+      ++stage.items;
+      // Буфер возвращается в кольцо; после закрытия чтения он не нужен
+      block.clear();
+      free.tryPush(block);
+    }
+    if (!cancelled && !batches.isClosed()) {
+      scanner.finish();
+      if (!batch.empty()) {
+        waitFor(stage, [&]() { return batches.push(std::move(batch)); });
+      }
+    }
+    finishStage(stage, start);
+  }
+
+  static void buildStage(SpscQueue<Batch>& batches, const Build& build,
+                         PipelineStageMetrics& stage) {
+    auto start = Clock::now();
+    Batch batch;
+    while (waitFor(stage, [&]() { return batches.pop(batch); })) {
+      for (auto& object : batch) build(object.section, object.text);
+      stage.items += batch.size();
+    }
+    finishStage(stage, start);
+  }
+};
+
+}  // namespace financial::infrastructure
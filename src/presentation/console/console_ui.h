@@ -798,8 +798,22 @@ class ConsoleUI {
   void importFromJSON() {
     std::string filename = getUserInput("Имя файла JSON (должен находиться в cmake-build-debug): ");
     try {
-      analyticsFacade_->importFromJSON(filename);
+      auto summary = analyticsFacade_->importFromJSON(filename);
       std::cout << "✓ Данные импортированы из " << filename << "\n";
+      std::cout << "  Счетов: " << summary.accountsImported
+                << ", категорий: " << summary.categoriesImported
+                << ", операций: " << summary.operationsImported << "\n";
+      size_t updated = summary.accountsUpdated + summary.categoriesUpdated +
+                       summary.operationsUpdated;
+      if (updated > 0) {
+        std::cout << "  Обновлено существующих записей: " << updated << "\n";
+      }
+      size_t duplicates = summary.exactDuplicates + summary.fuzzyDuplicates;
+      if (duplicates > 0) {
+        std::cout << "  Пропущено дубликатов: " << duplicates
+                  << " (точных: " << summary.exactDuplicates
+                  << ", похожих: " << summary.fuzzyDuplicates << ")\n";
+      }
     } catch (const std::exception& e) {
       std::cout << "✗ Ошибка: " << e.what() << "\n";
     }
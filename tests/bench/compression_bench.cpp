@@ -0,0 +1,77 @@
+// Сравнение уровней сжатия экспорта: одна и та же выгрузка пишется в
+// .gz на уровнях Gzip::MIN_LEVEL..Gzip::MAX_LEVEL, для каждого
+// печатаются CompressionStats — степень сжатия и скорость в МБ/с.
+//
+// Запуск: compression_bench [операций] [формат json|csv]
+
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "infrastructure/di/di_container.h"
+#include "infrastructure/serialization/data_exporter.h"
+
+using namespace financial;
+using namespace financial::domain;
+using namespace financial::infrastructure;
+
+int main(int argc, char** argv) {
+  const size_t operationCount =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  const std::string format = argc > 2 ? argv[2] : "json";
+
+  ServiceConfigurator::configureServices();
+  auto factory = ServiceLocator::get<IEntityFactory>();
+
+  std::vector<std::shared_ptr<BankAccount>> accounts;
+  for (int i = 0; i < 16; ++i) {
+    accounts.push_back(factory->createBankAccount(
+        "Account " + std::to_string(i), Money(100000, "RUB")));
+  }
+  std::vector<std::shared_ptr<Category>> categories;
+  for (int i = 0; i < 32; ++i) {
+    categories.push_back(factory->createCategory(
+        i % 4 == 0 ? CategoryType::INCOME : CategoryType::EXPENSE,
+        "Category " + std::to_string(i)));
+  }
+
+  // Описания из небольшого словаря, как в реальной выписке
+  static const char* DESCRIPTIONS[] = {"Продукты", "Кафе", "Такси",
+                                       "Аренда", "Зарплата", "Связь",
+                                       "Аптека", "Перевод"};
+  std::mt19937 random(42);
+  std::vector<std::shared_ptr<Operation>> operations;
+  operations.reserve(operationCount);
+  auto now = DateTimeUtils::now();
+  for (size_t i = 0; i < operationCount; ++i) {
+    const auto& category = categories[random() % categories.size()];
+    operations.push_back(factory->createOperation(
+        category->getType() == CategoryType::INCOME ? OperationType::INCOME
+                                                    : OperationType::EXPENSE,
+        accounts[random() % accounts.size()]->getId(),
+        Money((random() % 1000000) / 100.0, "RUB"), category->getId(),
+        DESCRIPTIONS[random() % 8], now - std::chrono::minutes(random() % 525600)));
+  }
+
+  const std::string filename = "compression_bench." + format + ".gz";
+  std::cout << "level  ratio   MB/s    in(MB)  out(MB)\n";
+  for (int level = Gzip::MIN_LEVEL; level <= Gzip::MAX_LEVEL; ++level) {
+    auto exporter = ExporterFactory::create(format);
+    exporter->setCompressionLevel(level);
+    exporter->exportToFile(filename, accounts, categories, operations);
+
+    const auto& stats = exporter->lastCompressionStats();
+    std::cout << std::setw(5) << level << "  " << std::fixed
+              << std::setprecision(3) << stats.ratio() << "  "
+              << std::setprecision(1) << std::setw(6)
+              << stats.megabytesPerSecond() << "  " << std::setw(7)
+              << stats.bytesIn / (1024.0 * 1024.0) << "  " << std::setw(7)
+              << stats.bytesOut / (1024.0 * 1024.0) << "\n";
+  }
+  std::remove(filename.c_str());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+// ConcurrentHashMap против std::unordered_map под одним мьютексом.
+// T потоков выполняют поиск и запись (присваивание или удаление со
+// вставкой) по случайным ключам общего набора. Для T = 1, 2, 4 … 64 и
+// доли чтений 50, 90, 99 и 100% печатается число операций в секунду
+// обеих таблиц и их отношение.
+//
+// Запуск: concurrent_map_bench [макс. потоков] [ключи] [секунд на шаг]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/concurrent_hash_map.h"
+
+using namespace financial;
+
+namespace {
+
+using Key = uint64_t;
+using Value = uint64_t;
+
+size_t argOr(int argc, char** argv, int index, size_t fallback) {
+  return argc > index ? std::strtoul(argv[index], nullptr, 10) : fallback;
+}
+
+class LockedMap {
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<Key, Value> map_;
+
+ public:
+  std::optional<Value> find(Key key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end()) return std::nullopt;
+    return it->second;
+  }
+
+  void insertOrAssign(Key key, Value value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_.insert_or_assign(key, value);
+  }
+
+  void erase(Key key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_.erase(key);
+  }
+};
+
+// Операций в секунду; readPercent — доля поисков, остальное — записи,
+// из них каждая четвёртая удаляет ключ и сразу вставляет его заново
+template <typename Map>
+double measure(Map& map, size_t keys, size_t threads, unsigned readPercent,
+               double seconds) {
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> operations{0};
+  std::atomic<size_t> hits{0};
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      std::mt19937_64 random(t + 1);
+      size_t done = 0;
+      size_t found = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        uint64_t draw = random();
+        Key key = draw % keys;
+        if ((draw >> 32) % 100 < readPercent) {
+          if (map.find(key)) ++found;
+        } else if ((draw >> 40) % 4 == 0) {
+          map.erase(key);
+          map.insertOrAssign(key, draw);
+        } else {
+          map.insertOrAssign(key, draw);
+        }
+        ++done;
+      }
+      operations += done;
+      hits += found;
+    });
+  }
+
+  auto started = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop = true;
+  for (auto& worker : workers) worker.join();
+
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - started)
+                       .count();
+  // Почти все поиски попадают: промахи — только окна удаления
+  if (hits == 0 && readPercent > 0) std::cerr << "no lookups hit\n";
+  return operations / elapsed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t maxThreads = std::max<size_t>(1, argOr(argc, argv, 1, 64));
+  const size_t keys = std::max<size_t>(1, argOr(argc, argv, 2, 100000));
+  const double seconds = argc > 3 ? std::strtod(argv[3], nullptr) : 0.5;
+
+  ConcurrentHashMap<Key, Value> concurrent;
+  LockedMap locked;
+  concurrent.reserve(keys);
+  for (Key key = 0; key < keys; ++key) {
+    concurrent.insertOrAssign(key, key);
+    locked.insertOrAssign(key, key);
+  }
+
+  std::cout << "reads%  threads  concurrent ops/s  mutex ops/s  speedup\n";
+  for (unsigned readPercent : {50u, 90u, 99u, 100u}) {
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+      double a = measure(concurrent, keys, threads, readPercent, seconds);
+      double b = measure(locked, keys, threads, readPercent, seconds);
+      std::cout << std::setw(6) << readPercent << "  " << std::setw(7)
+                << threads << "  " << std::setw(16) << static_cast<size_t>(a)
+                << "  " << std::setw(11) << static_cast<size_t>(b) << "  "
+                << std::fixed << std::setprecision(2) << std::setw(7) << a / b
+                << "\n";
+    }
+  }
+  return EXIT_SUCCESS;
+}
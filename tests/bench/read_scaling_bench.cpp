@@ -0,0 +1,103 @@
+// Масштабирование чтения по числу потоков: T читателей вызывают
+// findById по случайным счетам, один писатель всё это время обновляет
+// счета. Для T = 1, 2, 4 … до заданного максимума печатается
+// пропускная способность чтения InMemoryRepository (ConcurrentHashMap
+// с отложенным освобождением узлов) и PersistentRepository.
+//
+// Запуск: read_scaling_bench [макс. потоков] [счета] [секунд на шаг]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "infrastructure/persistence/in_memory_repository.h"
+#include "infrastructure/persistence/persistent_repository.h"
+
+using namespace financial;
+using namespace financial::domain;
+using namespace financial::infrastructure;
+
+namespace {
+
+size_t argOr(int argc, char** argv, int index, size_t fallback) {
+  return argc > index ? std::strtoul(argv[index], nullptr, 10) : fallback;
+}
+
+// Чтений в секунду при readers потоках и одном писателе
+double measure(IBankAccountRepository& repository, const std::vector<Id>& ids,
+               size_t readers, double seconds) {
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> reads{0};
+
+  std::thread writer([&] {
+    std::mt19937 random(7);
+    long number = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      const Id& id = ids[random() % ids.size()];
+      repository.update(std::make_shared<BankAccount>(
+          id, "Account", Money(static_cast<double>(++number), "RUB")));
+    }
+  });
+
+  std::vector<std::thread> threads;
+  for (size_t r = 0; r < readers; ++r) {
+    threads.emplace_back([&, r] {
+      std::mt19937 random(static_cast<unsigned>(r + 1));
+      size_t done = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        repository.findById(ids[random() % ids.size()]);
+        ++done;
+      }
+      reads += done;
+    });
+  }
+
+  auto started = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop = true;
+  for (auto& thread : threads) thread.join();
+  writer.join();
+
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - started)
+                       .count();
+  return reads / elapsed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t maxThreads = argOr(
+      argc, argv, 1, std::max(1u, std::thread::hardware_concurrency()) * 2);
+  const size_t accountCount = std::max<size_t>(1, argOr(argc, argv, 2, 10000));
+  const double seconds = argc > 3 ? std::strtod(argv[3], nullptr) : 1.0;
+
+  std::vector<Id> ids;
+  ids.reserve(accountCount);
+  InMemoryBankAccountRepository inMemory;
+  PersistentBankAccountRepository persistent;
+  for (size_t i = 0; i < accountCount; ++i) {
+    ids.push_back("ACC-" + std::to_string(i));
+    auto account =
+        std::make_shared<BankAccount>(ids.back(), "Account", Money(0, "RUB"));
+    inMemory.save(account);
+    persistent.save(account);
+  }
+
+  std::cout << "threads  in-memory reads/s  persistent reads/s\n";
+  for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+    double a = measure(inMemory, ids, threads, seconds);
+    double b = measure(persistent, ids, threads, seconds);
+    std::cout << std::setw(7) << threads << "  " << std::setw(17)
+              << static_cast<size_t>(a) << "  " << std::setw(18)
+              << static_cast<size_t>(b) << "\n";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,167 @@
+// Нагрузочный тест репозиториев: читатели без блокировок вызывают
+// findById и findAll, пока писатели обновляют, удаляют и заново
+// сохраняют те же счета. Проверяются оба хранилища — ConcurrentHashMap
+// с отложенным освобождением узлов (InMemoryRepository) и неизменяемое
+// отображение (PersistentRepository).
+//
+// Каждая версия счёта согласована сама с собой: имя "v<N>", баланс N.
+// Читатель, увидевший несогласованный или повторённый в одном findAll
+// счёт, считает нарушение. Ошибки доступа к освобождённой памяти ловит
+// сборка с FINANCIAL_TSAN (или ASan).
+//
+// Запуск: repository_stress_test [читатели] [писатели] [секунды]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "infrastructure/persistence/in_memory_repository.h"
+#include "infrastructure/persistence/persistent_repository.h"
+
+using namespace financial;
+using namespace financial::domain;
+using namespace financial::infrastructure;
+
+namespace {
+
+constexpr size_t ACCOUNTS = 256;
+// Каждый FINDALL_EVERY-й запрос читателя — findAll
+constexpr size_t FINDALL_EVERY = 64;
+
+size_t argOr(int argc, char** argv, int index, size_t fallback) {
+  return argc > index ? std::strtoul(argv[index], nullptr, 10) : fallback;
+}
+
+Id accountId(size_t index) { return "ACC-" + std::to_string(index); }
+
+std::shared_ptr<BankAccount> version(size_t index, long number) {
+  return std::make_shared<BankAccount>(accountId(index),
+                                       "v" + std::to_string(number),
+                                       Money(number, "RUB"));
+}
+
+bool consistent(const BankAccount& account) {
+  auto number = static_cast<long>(account.getBalance().getAmount());
+  return account.getName() == "v" + std::to_string(number);
+}
+
+struct Result {
+  size_t reads = 0;
+  size_t writes = 0;
+  size_t violations = 0;
+  double seconds = 0;
+};
+
+// Писатель w владеет счетами с index % writers == w, поэтому знает,
+// есть ли счёт в репозитории, и update не встречает удалённых
+Result run(IBankAccountRepository& repository, size_t readers,
+           size_t writers, double seconds) {
+  for (size_t i = 0; i < ACCOUNTS; ++i) repository.save(version(i, 0));
+
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> reads{0};
+  std::atomic<size_t> writes{0};
+  std::atomic<size_t> violations{0};
+
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < writers; ++w) {
+    threads.emplace_back([&, w] {
+      std::mt19937 random(static_cast<unsigned>(w + 1));
+      std::vector<bool> present(ACCOUNTS, true);
+      long number = 0;
+      size_t done = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        size_t index = w + writers * (random() % (ACCOUNTS / writers));
+        ++number;
+        if (!present[index]) {
+          repository.save(version(index, number));
+          present[index] = true;
+        } else if (random() % 4 == 0) {
+          repository.remove(accountId(index));
+          present[index] = false;
+        } else {
+          repository.update(version(index, number));
+        }
+        ++done;
+      }
+      writes += done;
+    });
+  }
+
+  for (size_t r = 0; r < readers; ++r) {
+    threads.emplace_back([&, r] {
+      std::mt19937 random(static_cast<unsigned>(1000 + r));
+      size_t done = 0;
+      size_t bad = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (++done % FINDALL_EVERY == 0) {
+          std::unordered_set<Id> seen;
+          for (const auto& account : repository.findAll()) {
+            bool repeated = !seen.insert(account->getId()).second;
+            if (repeated || !consistent(*account)) ++bad;
+          }
+          continue;
+        }
+        size_t index = random() % ACCOUNTS;
+        if (auto account = repository.findById(accountId(index))) {
+          const auto& found = **account;
+          if (found.getId() != accountId(index) || !consistent(found)) ++bad;
+        }
+      }
+      reads += done;
+      violations += bad;
+    });
+  }
+
+  auto started = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop = true;
+  for (auto& thread : threads) thread.join();
+
+  Result result;
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - started)
+                       .count();
+  result.reads = reads;
+  result.writes = writes;
+  result.violations = violations;
+  return result;
+}
+
+bool report(const std::string& name, const Result& result) {
+  std::cout << name << ": reads/sec="
+            << static_cast<size_t>(result.reads / result.seconds)
+            << " writes/sec="
+            << static_cast<size_t>(result.writes / result.seconds)
+            << " violations=" << result.violations << "\n";
+  return result.violations == 0 && result.reads > 0 && result.writes > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t readers = argOr(argc, argv, 1, 8);
+  const size_t writers =
+      std::clamp<size_t>(argOr(argc, argv, 2, 2), 1, ACCOUNTS);
+  const double seconds = argc > 3 ? std::strtod(argv[3], nullptr) : 1.0;
+
+  bool ok = true;
+  {
+    InMemoryBankAccountRepository repository;
+    ok &= report("InMemoryRepository",
+                 run(repository, readers, writers, seconds));
+  }
+  {
+    PersistentBankAccountRepository repository;
+    ok &= report("PersistentRepository",
+                 run(repository, readers, writers, seconds));
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
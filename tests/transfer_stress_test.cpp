@@ -0,0 +1,118 @@
+// Нагрузочный тест переводов: N потоков переводят случайные суммы между
+// случайными счетами общего набора. Печатает число переводов в секунду и
+// проверяет, что суммарный баланс счетов не изменился, а на каждый
+// успешный перевод сохранено ровно две проводки.
+//
+// Запуск: transfer_stress_test [потоки] [счета] [переводов на поток]
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "infrastructure/di/di_container.h"
+
+using namespace financial;
+using namespace financial::domain;
+using namespace financial::infrastructure;
+
+namespace {
+
+size_t argOr(int argc, char** argv, int index, size_t fallback) {
+  return argc > index ? std::strtoul(argv[index], nullptr, 10) : fallback;
+}
+
+double totalBalance(IBankAccountRepository& accounts) {
+  double total = 0;
+  for (const auto& account : accounts.findAll()) {
+    total += account->getBalance().getAmount();
+  }
+  return total;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t threads = argOr(argc, argv, 1, 8);
+  const size_t accountCount = argOr(argc, argv, 2, 64);
+  const size_t transfersPerThread = argOr(argc, argv, 3, 2000);
+  constexpr double INITIAL_BALANCE = 1000;
+
+  ServiceConfigurator::configureServices();
+  auto factory = ServiceLocator::get<IEntityFactory>();
+  auto accounts = ServiceLocator::get<IBankAccountRepository>();
+  auto operations = ServiceLocator::get<IOperationRepository>();
+  auto transfers = ServiceLocator::get<TransferService>();
+
+  std::vector<Id> ids;
+  ids.reserve(accountCount);
+  for (size_t i = 0; i < accountCount; ++i) {
+    ids.push_back("ACC-" + std::to_string(i));
+    accounts->save(factory->restoreBankAccount(
+        ids.back(), "Account " + std::to_string(i),
+        Money(INITIAL_BALANCE, "RUB"), "4080" + std::to_string(i)));
+  }
+  const double before = totalBalance(*accounts);
+  const size_t operationsBefore = operations->count();
+
+  std::atomic<size_t> completed{0};
+  std::atomic<size_t> rejected{0};
+  std::atomic<size_t> failed{0};
+
+  auto started = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      std::mt19937 random(static_cast<unsigned>(t + 1));
+      std::uniform_int_distribution<size_t> pick(0, accountCount - 1);
+      std::uniform_int_distribution<int> cents(1, 20000);
+      for (size_t i = 0; i < transfersPerThread; ++i) {
+        size_t from = pick(random);
+        size_t to = pick(random);
+        if (from == to) to = (to + 1) % accountCount;
+        try {
+          transfers->transfer(ids[from], ids[to],
+                              Money(cents(random) / 100.0, "RUB"));
+          completed++;
+        } catch (const InsufficientFundsException&) {
+          rejected++;
+        } catch (const std::exception& e) {
+          std::cerr << "transfer failed: " << e.what() << "\n";
+          failed++;
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - started)
+                       .count();
+
+  const double after = totalBalance(*accounts);
+  const size_t savedLegs = operations->count() - operationsBefore;
+
+  std::cout << "threads=" << threads << " accounts=" << accountCount
+            << " transfers=" << completed << " rejected=" << rejected
+            << " transfers/sec=" << static_cast<size_t>(completed / seconds)
+            << "\n";
+
+  bool ok = true;
+  // Суммы — центы, сумма остаётся точной в пределах ошибки округления
+  if (std::abs(after - before) > 1e-6 * before) {
+    std::cerr << "total balance changed: " << before << " -> " << after
+              << "\n";
+    ok = false;
+  }
+  if (savedLegs != 2 * completed) {
+    std::cerr << "expected " << 2 * completed << " postings, saved "
+              << savedLegs << "\n";
+    ok = false;
+  }
+  if (failed != 0) ok = false;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}